@@ -18,34 +18,48 @@
  */
 
 #include "ControlSignal.h"
-#include "MainWindow.h"
 
 #include <QtCore/QObject>
 
-ControlSignal::ControlSignal() : VerilogSignal()
+ControlSignal::ControlSignal() : VerilogSignal(), mRegistered(false)
 {
     // Nothing to see here.
 }
 
+bool ControlSignal::registered() const
+{
+    return mRegistered;
+}
+
+void ControlSignal::setRegistered(bool _registered)
+{
+    mRegistered = _registered;
+}
+
 QString ControlSignal::declaration() const
 {
     return QObject::tr("reg %1;").arg(name());
 }
 
-QDomElement ControlSignal::toXml(QDomDocument doc) const
+void ControlSignal::write(QXmlStreamWriter& xml) const
 {
-    QDomElement node = doc.createElement("control_signal");
-    node.setAttribute("name", name());
-
-    return node;
+    xml.writeStartElement("control_signal");
+    xml.writeAttribute("name", name());
+    if(mRegistered)
+        xml.writeAttribute("registered", "1");
+    xml.writeEndElement();
 }
 
-ControlSignal* ControlSignal::fromXml(const QDomElement& node)
+ControlSignal* ControlSignal::fromXml(QXmlStreamReader& xml)
 {
+    QXmlStreamAttributes attrs = xml.attributes();
+
     ControlSignal *sig = new ControlSignal;
-    sig->setName(node.attribute("name").trimmed());
-    if(!MainWindow::validIdentifier(sig->name()))
+    sig->setName(attrs.value("name").toString().trimmed());
+    if(!validIdentifier(sig->name()))
         sig->setName("invalid_name");
 
+    sig->setRegistered(attrs.value("registered").toString().trimmed().toInt());
+
     return sig;
 }
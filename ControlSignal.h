@@ -20,8 +20,8 @@
 #ifndef CONTROLSIGNAL_H
 #define CONTROLSIGNAL_H
 
-#include <QtXml/QDomDocument>
-#include <QtXml/QDomElement>
+#include <QtCore/QXmlStreamReader>
+#include <QtCore/QXmlStreamWriter>
 
 #include "VerilogSignal.h"
 
@@ -30,10 +30,18 @@ class ControlSignal : public VerilogSignal
 public:
     ControlSignal();
 
+    /// Registered signals are decoded from next_state and driven by a flop.
+    bool registered() const;
+    void setRegistered(bool registered);
+
     QString declaration() const;
 
-    QDomElement toXml(QDomDocument doc) const;
-    static ControlSignal* fromXml(const QDomElement& node);
+    void write(QXmlStreamWriter& xml) const;
+    /// Read the element the reader is at. The caller checks the name.
+    static ControlSignal* fromXml(QXmlStreamReader& xml);
+
+private:
+    bool mRegistered;
 };
 
 #endif // CONTROLSIGNAL_H
@@ -18,6 +18,7 @@
  */
 
 #include "ControlSignalModel.h"
+#include "SymbolTable.h"
 
 ControlSignalModel::ControlSignalModel(QObject *parent) :
     QAbstractListModel(parent)
@@ -41,7 +42,7 @@ QVariant ControlSignalModel::data(const QModelIndex& index, int role) const
     if(index.row() < 0 || index.row() >= mControlSignals.count())
         return QVariant();
 
-    if(role != Qt::DisplayRole)
+    if(role != Qt::DisplayRole && role != SymbolTable::Role_Name)
         return QVariant();
 
     ControlSignal *sig = mControlSignals.at(index.row());
@@ -69,6 +70,78 @@ void ControlSignalModel::append(ControlSignal *sig)
     endInsertRows();
 }
 
+void ControlSignalModel::insert(int index, ControlSignal *sig)
+{
+    if(contains(sig->name()))
+        return;
+
+    index = qBound(0, index, mControlSignals.count());
+
+    beginInsertRows(QModelIndex(), index, index);
+    mControlSignals.insert(index, sig);
+    mControlSignalsByName[sig->name()] = sig;
+    endInsertRows();
+}
+
+void ControlSignalModel::appendMany(const QList<ControlSignal*>& sigs)
+{
+    QList<ControlSignal*> added;
+    added.reserve(sigs.count());
+
+    // Names go in first so duplicates within the batch are caught as well.
+    mControlSignalsByName.reserve(mControlSignalsByName.count() + sigs.count());
+
+    foreach(ControlSignal *sig, sigs)
+    {
+        if(contains(sig->name()))
+        {
+            delete sig;
+            continue;
+        }
+
+        mControlSignalsByName.insert(sig->name(), sig);
+        added.append(sig);
+    }
+
+    if(added.isEmpty())
+        return;
+
+    int row = mControlSignals.count();
+
+    beginInsertRows(QModelIndex(), row, row + added.count() - 1);
+    mControlSignals.reserve(row + added.count());
+    mControlSignals.append(added);
+    endInsertRows();
+}
+
+void ControlSignalModel::replaceAll(const QList<ControlSignal*>& sigs)
+{
+    beginResetModel();
+
+    foreach(ControlSignal *sig, mControlSignals)
+        delete sig;
+
+    mControlSignals.clear();
+    mControlSignalsByName.clear();
+
+    mControlSignals.reserve(sigs.count());
+    mControlSignalsByName.reserve(sigs.count());
+
+    foreach(ControlSignal *sig, sigs)
+    {
+        if(contains(sig->name()))
+        {
+            delete sig;
+            continue;
+        }
+
+        mControlSignals.append(sig);
+        mControlSignalsByName.insert(sig->name(), sig);
+    }
+
+    endResetModel();
+}
+
 void ControlSignalModel::up(int index)
 {
     if(index < 1 || index >= mControlSignals.count())
@@ -133,18 +206,10 @@ void ControlSignalModel::update(int index)
     }
 
     emit dataChanged(this->index(index), this->index(index),
-        QVector<int>() << Qt::DisplayRole);
+        QVector<int>() << Qt::DisplayRole << SymbolTable::Role_Name);
 }
 
 void ControlSignalModel::clear()
 {
-    beginResetModel();
-
-    foreach(ControlSignal *sig, mControlSignals)
-        delete sig;
-
-    mControlSignals.clear();
-    mControlSignalsByName.clear();
-
-    endResetModel();
+    replaceAll(QList<ControlSignal*>());
 }
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EncodingSelector.h"
+#include "StateEncoder.h"
+
+#include <QtCore/QRegExp>
+#include <QtCore/QStringList>
+
+EncodingSelector::EncodingSelector(const Project& project,
+    const TransitionGraph& graph) :
+    mProject(project), mStates(project.states()), mOutputStates(0),
+    mSelected(0)
+{
+    QStringList controlNames;
+    foreach(const ControlSignal& sig, project.controlSignals())
+        controlNames.append(QRegExp::escape(sig.name()));
+
+    QRegExp controlAssign(QString("\\b(%1)\\s*=(?!=)").arg(
+        controlNames.join("|")));
+
+    for(int i = 0; i < mStates.count(); i++)
+    {
+        mTransitions.append(graph.targets(i));
+
+        if(!controlNames.isEmpty() &&
+            controlAssign.indexIn(mStates.at(i).code()) != -1)
+        {
+            mOutputStates++;
+        }
+    }
+
+    mEstimates.append(estimate(Project::Encoding_Binary));
+    mEstimates.append(estimate(Project::Encoding_Gray));
+    mEstimates.append(estimate(Project::Encoding_OneHot));
+
+    // Ties go to the earlier (denser) encoding.
+    for(int i = 1; i < mEstimates.count(); i++)
+    {
+        if(mEstimates.at(i).cost < mEstimates.at(mSelected).cost)
+            mSelected = i;
+    }
+}
+
+Project::Encoding EncodingSelector::selected() const
+{
+    return mEstimates.at(mSelected).encoding;
+}
+
+QList<EncodingSelector::Estimate> EncodingSelector::estimates() const
+{
+    return mEstimates;
+}
+
+QString EncodingSelector::report() const
+{
+    QString target = mProject.target() == Project::Target_ASIC ?
+        "ASIC" : "FPGA";
+
+    int transitions = 0;
+    foreach(const QList<int>& targets, mTransitions)
+        transitions += targets.count();
+
+    QString str = QString("// State encoding selected automatically for %1 "
+        "(%2 states, %3 transitions):\n").arg(target).arg(
+        mStates.count()).arg(transitions);
+
+    for(int i = 0; i < mEstimates.count(); i++)
+    {
+        const Estimate& est = mEstimates.at(i);
+
+        str += QString("//   %1 %2 flip-flops, %3 literals, %4 bit toggles, "
+            "cost %5%6\n").arg(encodingName(est.encoding).leftJustified(8)).arg(
+            est.flipFlops, 4).arg(est.literals, 6).arg(est.toggles, 5).arg(
+            est.cost, 0, 'f', 1).arg(i == mSelected ? " <- selected" : "");
+    }
+
+    return str;
+}
+
+QString EncodingSelector::encodingName(Project::Encoding encoding)
+{
+    switch(encoding)
+    {
+    case Project::Encoding_OneHot:
+        return "one-hot";
+    case Project::Encoding_Gray:
+        return "gray";
+    case Project::Encoding_Johnson:
+        return "johnson";
+    case Project::Encoding_Auto:
+        return "auto";
+    default:
+        return "binary";
+    }
+}
+
+EncodingSelector::Estimate EncodingSelector::estimate(
+    Project::Encoding encoding) const
+{
+    Estimate est;
+    est.encoding = encoding;
+    est.literals = 0;
+    est.toggles = 0;
+
+    StateEncoder encoder(encoding, mStates);
+    int bits = encoder.bits();
+    est.flipFlops = bits;
+
+    if(encoding == Project::Encoding_OneHot)
+    {
+        QList<int> fanIn;
+        for(int i = 0; i < mStates.count(); i++)
+            fanIn.append(0);
+
+        for(int i = 0; i < mTransitions.count(); i++)
+        {
+            foreach(int target, mTransitions.at(i))
+                fanIn[target]++;
+        }
+
+        // Each bit is set by its incoming transitions (state bit and
+        // condition) and held unless one of its own transitions fires.
+        for(int i = 0; i < mStates.count(); i++)
+            est.literals += 2 * fanIn.at(i) + 1 + mTransitions.at(i).count();
+
+        // Every transition clears one bit and sets another.
+        foreach(const QList<int>& targets, mTransitions)
+            est.toggles += 2 * targets.count();
+
+        // Outputs decode from a single bit.
+        est.literals += mOutputStates;
+    }
+    else
+    {
+        // Every bit that changes on a transition needs a term decoding the
+        // whole source state plus the condition.
+        for(int i = 0; i < mTransitions.count(); i++)
+        {
+            QString from = encoder.code(i);
+
+            foreach(int target, mTransitions.at(i))
+            {
+                QString to = encoder.code(target);
+
+                for(int b = 0; b < bits; b++)
+                {
+                    if(from.at(b) != to.at(b))
+                    {
+                        est.toggles++;
+                        est.literals += bits + 1;
+                    }
+                }
+            }
+        }
+
+        // Hold terms plus outputs decoding the whole state.
+        est.literals += bits + mOutputStates * bits;
+    }
+
+    // FPGAs have flip-flops to spare and absorb about four literals per
+    // LUT, while in an ASIC a flip-flop costs about six gates.
+    if(mProject.target() == Project::Target_ASIC)
+        est.cost = 6.0 * est.flipFlops + est.literals;
+    else
+        est.cost = est.flipFlops + est.literals / 4.0;
+
+    return est;
+}
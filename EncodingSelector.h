@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENCODINGSELECTOR_H
+#define ENCODINGSELECTOR_H
+
+#include <QtCore/QList>
+#include <QtCore/QString>
+
+#include "Project.h"
+#include "TransitionGraph.h"
+
+/**
+ * Picks binary, Gray or one-hot encoding for a project from a rough
+ * estimate of the flip-flops and next state/output decode logic each one
+ * needs on the project's target family.
+ */
+class EncodingSelector
+{
+public:
+    typedef struct _Estimate
+    {
+        Project::Encoding encoding;
+        int flipFlops;
+        int literals;
+        int toggles;
+        double cost;
+    }Estimate;
+
+    /// The graph must have been built from the same project.
+    EncodingSelector(const Project& project, const TransitionGraph& graph);
+
+    Project::Encoding selected() const;
+    QList<Estimate> estimates() const;
+
+    /// The estimates formatted as comment lines for the generated module.
+    QString report() const;
+
+    static QString encodingName(Project::Encoding encoding);
+
+private:
+    Estimate estimate(Project::Encoding encoding) const;
+
+    Project mProject;
+    QList<State> mStates;
+
+    /// Targets of each state, not counting staying in the same state.
+    QList<QList<int> > mTransitions;
+
+    /// Number of states that assign any control signal.
+    int mOutputStates;
+
+    QList<Estimate> mEstimates;
+    int mSelected;
+};
+
+#endif // ENCODINGSELECTOR_H
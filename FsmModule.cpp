@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FsmModule.h"
+
+FsmModule::FsmModule(const Project& project) : mProject(project),
+    mEncoding(project.encoding())
+{
+    // Nothing to see here.
+}
+
+const Project& FsmModule::project() const
+{
+    return mProject;
+}
+
+void FsmModule::setProject(const Project& project)
+{
+    mProject = project;
+
+    // Anything derived from the old states no longer applies.
+    mTransitions.clear();
+    mOutputs.clear();
+}
+
+Project::Encoding FsmModule::encoding() const
+{
+    return mEncoding;
+}
+
+void FsmModule::setEncoding(Project::Encoding encoding)
+{
+    mEncoding = encoding;
+}
+
+StateEncoder FsmModule::encoder() const
+{
+    return StateEncoder(mEncoding, mProject.states());
+}
+
+const TransitionGraph& FsmModule::transitions() const
+{
+    if(!mTransitions)
+        mTransitions = QSharedPointer<const TransitionGraph>(
+            new TransitionGraph(mProject));
+
+    return *mTransitions;
+}
+
+QSharedPointer<const RegisteredControls> FsmModule::outputs() const
+{
+    return mOutputs;
+}
+
+void FsmModule::setOutputs(const QSharedPointer<const RegisteredControls>& outputs)
+{
+    mOutputs = outputs;
+}
+
+QList<StateReducer::Merge> FsmModule::merged() const
+{
+    return mMerged;
+}
+
+void FsmModule::setMerged(const QList<StateReducer::Merge>& merged)
+{
+    mMerged = merged;
+}
+
+QStringList FsmModule::notes() const
+{
+    return mNotes;
+}
+
+void FsmModule::addNote(const QString& note)
+{
+    mNotes.append(note);
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FSMMODULE_H
+#define FSMMODULE_H
+
+#include <QtCore/QList>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QStringList>
+
+#include "Project.h"
+#include "RegisteredControls.h"
+#include "StateEncoder.h"
+#include "StateReducer.h"
+#include "TransitionGraph.h"
+
+/**
+ * The state machine as the backends see it. It is built once from a
+ * Project snapshot and refined by the passes in a PassManager, so no stage
+ * has to go back to the models or the widgets and each one can be timed.
+ */
+class FsmModule
+{
+public:
+    explicit FsmModule(const Project& project);
+
+    /// Signals, states and code sections as the passes left them.
+    const Project& project() const;
+    void setProject(const Project& project);
+
+    /// Encoding of the state vector. Encoding_Auto until a pass picks one.
+    Project::Encoding encoding() const;
+    void setEncoding(Project::Encoding encoding);
+
+    /// Codes of the current states in the current encoding.
+    StateEncoder encoder() const;
+
+    /// Transitions between the current states and those in the state
+    /// defaults and task code, parsed on first use.
+    const TransitionGraph& transitions() const;
+
+    /// Registered control signals, null until OutputPass has run or when
+    /// no control signal is registered.
+    QSharedPointer<const RegisteredControls> outputs() const;
+    void setOutputs(const QSharedPointer<const RegisteredControls>& outputs);
+
+    /// Merged states the backends keep declared as aliases.
+    QList<StateReducer::Merge> merged() const;
+    void setMerged(const QList<StateReducer::Merge>& merged);
+
+    /// Comment lines for the top of the module in the order they were
+    /// added. Each note ends in a newline.
+    QStringList notes() const;
+    void addNote(const QString& note);
+
+private:
+    Project mProject;
+    Project::Encoding mEncoding;
+
+    mutable QSharedPointer<const TransitionGraph> mTransitions;
+    QSharedPointer<const RegisteredControls> mOutputs;
+
+    QList<StateReducer::Merge> mMerged;
+    QStringList mNotes;
+};
+
+#endif // FSMMODULE_H
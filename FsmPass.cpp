@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FsmPass.h"
+#include "EncodingSelector.h"
+#include "FsmModule.h"
+
+FsmPass::~FsmPass()
+{
+    // Nothing to see here.
+}
+
+QString ReducePass::name() const
+{
+    return "reduce";
+}
+
+void ReducePass::run(FsmModule& module)
+{
+    const Project& project = module.project();
+
+    if(!project.removeUnreachable() && !project.mergeEquivalent())
+        return;
+
+    StateReducer reducer(project, module.transitions());
+
+    module.setProject(reducer.reduced());
+    module.setMerged(reducer.merged());
+
+    QString report = reducer.report();
+    if(!report.isEmpty())
+        module.addNote(report);
+}
+
+QString EncodingPass::name() const
+{
+    return "encoding";
+}
+
+void EncodingPass::run(FsmModule& module)
+{
+    if(module.encoding() != Project::Encoding_Auto)
+        return;
+
+    EncodingSelector selector(module.project(), module.transitions());
+
+    module.setEncoding(selector.selected());
+    module.addNote(selector.report());
+}
+
+QString OutputPass::name() const
+{
+    return "outputs";
+}
+
+void OutputPass::run(FsmModule& module)
+{
+    // Finding the registered signals copies all the state code, which is
+    // wasted when none are marked.
+    bool anyRegistered = false;
+    foreach(const ControlSignal& sig, module.project().controlSignals())
+    {
+        if(sig.registered())
+            anyRegistered = true;
+    }
+
+    if(!anyRegistered)
+    {
+        module.setOutputs(QSharedPointer<const RegisteredControls>());
+        return;
+    }
+
+    // Merged states stay declared as aliases.
+    QStringList aliases;
+    foreach(const StateReducer::Merge& merge, module.merged())
+        aliases.append(merge.state);
+
+    module.setOutputs(QSharedPointer<const RegisteredControls>(
+        new RegisteredControls(module.project(), aliases)));
+}
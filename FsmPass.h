@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FSMPASS_H
+#define FSMPASS_H
+
+#include <QtCore/QString>
+
+class FsmModule;
+
+/// One analysis or optimization step over an FsmModule.
+class FsmPass
+{
+public:
+    virtual ~FsmPass();
+
+    /// Short name for the timing report.
+    virtual QString name() const = 0;
+
+    virtual void run(FsmModule& module) = 0;
+};
+
+/// Removes unreachable and merges equivalent states if the project asks.
+class ReducePass : public FsmPass
+{
+public:
+    virtual QString name() const;
+    virtual void run(FsmModule& module);
+};
+
+/// Picks the cheapest encoding for projects set to Encoding_Auto.
+class EncodingPass : public FsmPass
+{
+public:
+    virtual QString name() const;
+    virtual void run(FsmModule& module);
+};
+
+/// Works out which control signals can come straight from a register.
+class OutputPass : public FsmPass
+{
+public:
+    virtual QString name() const;
+    virtual void run(FsmModule& module);
+};
+
+#endif // FSMPASS_H
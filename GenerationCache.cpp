@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GenerationCache.h"
+#include "VerilogGenerator.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QList>
+
+QByteArray GenerationCache::key(const Project& project)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(VerilogGenerator::version()) + ":");
+    hash.addData(project.hash());
+
+    return hash.result().toHex();
+}
+
+QString GenerationCache::sidecarPath(const QString& outputPath)
+{
+    QFileInfo info(outputPath);
+
+    return QString("%1/.%2.sof").arg(info.absolutePath()).arg(
+        info.fileName());
+}
+
+QByteArray GenerationCache::dataHash(const QByteArray& data)
+{
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+}
+
+bool GenerationCache::upToDate(const Project& project,
+    const QString& outputPath)
+{
+    QFile sidecar(sidecarPath(outputPath));
+    if(!sidecar.open(QIODevice::ReadOnly))
+        return false;
+
+    // The project key, the size of the module and the module's hash.
+    QList<QByteArray> fields = sidecar.readAll().simplified().split(' ');
+    if(fields.count() != 3 || fields.at(0) != key(project))
+        return false;
+
+    // Check the size first so a changed module is usually never read.
+    QFile output(outputPath);
+    if(!output.exists() || output.size() != fields.at(1).toLongLong() ||
+        !output.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if(!hash.addData(&output))
+        return false;
+
+    return hash.result().toHex() == fields.at(2);
+}
+
+bool GenerationCache::matches(const QString& path, const QByteArray& data)
+{
+    QFile existing(path);
+
+    // Check the size first so a changed module is usually never read.
+    if(!existing.exists() || existing.size() != data.size() ||
+        !existing.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    return existing.readAll() == data;
+}
+
+GenerationCache::Status GenerationCache::writeIfChanged(const QString& path,
+    const QByteArray& data)
+{
+    if(matches(path, data))
+        return Status_Unchanged;
+
+    QFile genFile(path);
+    if(!genFile.open(QIODevice::WriteOnly) ||
+        genFile.write(data) != data.size())
+    {
+        return Status_Failed;
+    }
+
+    genFile.close();
+
+    return Status_Written;
+}
+
+bool GenerationCache::store(const QByteArray& key,
+    const QString& outputPath, const QByteArray& data)
+{
+    QByteArray line = key + " " + QByteArray::number(data.size()) + " " +
+        dataHash(data) + "\n";
+
+    QFile sidecar(sidecarPath(outputPath));
+    if(!sidecar.open(QIODevice::WriteOnly) ||
+        sidecar.write(line) != line.size())
+    {
+        return false;
+    }
+
+    sidecar.close();
+
+    return true;
+}
+
+GenerationCache::Status GenerationCache::generate(const Project& project,
+    const QString& outputPath, bool force, QList<PassManager::Timing> *timings)
+{
+    if(!force && upToDate(project, outputPath))
+        return Status_UpToDate;
+
+    VerilogGenerator generator(project);
+
+    // Generate straight into the bytes that get compared and written.
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if(!generator.generate(&buffer))
+        return Status_Failed;
+
+    if(timings)
+    {
+        PassManager::Timing output;
+        output.stage = "verilog";
+        output.nsecs = timer.nsecsElapsed();
+
+        *timings = generator.timings();
+        timings->append(output);
+    }
+
+    Status status = writeIfChanged(outputPath, data);
+
+    // A missing sidecar only costs a regeneration next time.
+    if(status != Status_Failed)
+        store(key(project), outputPath, data);
+
+    return status;
+}
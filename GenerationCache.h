@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENERATIONCACHE_H
+#define GENERATIONCACHE_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+#include "PassManager.h"
+#include "Project.h"
+
+/**
+ * Keeps generated modules from being rewritten when nothing changed so the
+ * file times stay put for make based flows. The project hash and the hash
+ * of the module written for it are kept in a sidecar file next to the
+ * module, so a module changed by anything else is generated again.
+ */
+class GenerationCache
+{
+public:
+    typedef enum _Status
+    {
+        Status_Failed = 0,
+        Status_Written,
+        Status_Unchanged,
+        Status_UpToDate
+    }Status;
+
+    /// Hash of the project combined with the generator version.
+    static QByteArray key(const Project& project);
+
+    /// Path of the sidecar that holds the hash for an output file.
+    static QString sidecarPath(const QString& outputPath);
+
+    /// Hash of a generated module as kept in the sidecar.
+    static QByteArray dataHash(const QByteArray& data);
+
+    /**
+     * True when the output was generated from this project and still holds
+     * what was generated.
+     */
+    static bool upToDate(const Project& project, const QString& outputPath);
+
+    /// True when the file already holds exactly these bytes.
+    static bool matches(const QString& path, const QByteArray& data);
+
+    /**
+     * Write the data unless the file already holds exactly the same bytes.
+     * Returns Status_Written, Status_Unchanged or Status_Failed.
+     */
+    static Status writeIfChanged(const QString& path, const QByteArray& data);
+
+    /// Record that the output holds data generated for the given key.
+    static bool store(const QByteArray& key, const QString& outputPath,
+        const QByteArray& data);
+
+    /**
+     * Generate, write and record the project unless it is up to date. The
+     * time of each pass and of the output stage go to timings if given.
+     */
+    static Status generate(const Project& project, const QString& outputPath,
+        bool force = false, QList<PassManager::Timing> *timings = 0);
+};
+
+#endif // GENERATIONCACHE_H
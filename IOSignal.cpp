@@ -18,7 +18,6 @@
  */
 
 #include "IOSignal.h"
-#include "MainWindow.h"
 
 #include <QtCore/QObject>
 
@@ -98,50 +97,51 @@ QString IOSignal::declaration() const
         ).arg(_size).arg(name());
 }
 
-QDomElement IOSignal::toXml(QDomDocument doc) const
+void IOSignal::write(QXmlStreamWriter& xml) const
 {
-    QDomElement node = doc.createElement("io_signal");
-    node.setAttribute("name", name());
+    xml.writeStartElement("io_signal");
+    xml.writeAttribute("name", name());
 
     switch(mDirection)
     {
     case Direction_Output:
-        node.setAttribute("direction", "output");
+        xml.writeAttribute("direction", "output");
         break;
     case Direction_Inout:
-        node.setAttribute("direction", "inout");
+        xml.writeAttribute("direction", "inout");
         break;
     default:
-        node.setAttribute("direction", "input");
+        xml.writeAttribute("direction", "input");
         break;
     }
 
     switch(mType)
     {
     case Type_Reg:
-        node.setAttribute("type", "reg");
+        xml.writeAttribute("type", "reg");
         break;
     case Type_Logic:
-        node.setAttribute("type", "logic");
+        xml.writeAttribute("type", "logic");
         break;
     default:
-        node.setAttribute("type", "wire");
+        xml.writeAttribute("type", "wire");
         break;
     }
 
-    node.setAttribute("size", mSize);
-
-    return node;
+    xml.writeAttribute("size", QString::number(mSize));
+    xml.writeEndElement();
 }
 
-IOSignal* IOSignal::fromXml(const QDomElement& node)
+IOSignal* IOSignal::fromXml(QXmlStreamReader& xml)
 {
+    QXmlStreamAttributes attrs = xml.attributes();
+
     IOSignal *sig = new IOSignal;
-    sig->setName(node.attribute("name").trimmed());
-    if(!MainWindow::validIdentifier(sig->name()))
+    sig->setName(attrs.value("name").toString().trimmed());
+    if(!validIdentifier(sig->name()))
         sig->setName("invalid_name");
 
-    QString dir = node.attribute("direction").trimmed().toLower();
+    QString dir = attrs.value("direction").toString().trimmed().toLower();
 
     if(dir == "output")
         sig->setDirection(IOSignal::Direction_Output);
@@ -150,7 +150,7 @@ IOSignal* IOSignal::fromXml(const QDomElement& node)
     else
         sig->setDirection(IOSignal::Direction_Input);
 
-    QString _type = node.attribute("type").trimmed().toLower();
+    QString _type = attrs.value("type").toString().trimmed().toLower();
 
     if(_type == "reg")
         sig->setType(IOSignal::Type_Reg);
@@ -159,7 +159,7 @@ IOSignal* IOSignal::fromXml(const QDomElement& node)
     else
         sig->setType(IOSignal::Type_Wire);
 
-    sig->setSize(node.attribute("size").trimmed().toInt());
+    sig->setSize(attrs.value("size").toString().trimmed().toInt());
     if(sig->size() < 1)
         sig->setSize(1);
 
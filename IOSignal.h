@@ -20,8 +20,8 @@
 #ifndef IOSIGNAL_H
 #define IOSIGNAL_H
 
-#include <QtXml/QDomDocument>
-#include <QtXml/QDomElement>
+#include <QtCore/QXmlStreamReader>
+#include <QtCore/QXmlStreamWriter>
 
 #include "VerilogSignal.h"
 
@@ -55,8 +55,9 @@ public:
 
     QString declaration() const;
 
-    QDomElement toXml(QDomDocument doc) const;
-    static IOSignal* fromXml(const QDomElement& node);
+    void write(QXmlStreamWriter& xml) const;
+    /// Read the element the reader is at. The caller checks the name.
+    static IOSignal* fromXml(QXmlStreamReader& xml);
 
 private:
     Type mType;
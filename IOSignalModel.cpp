@@ -18,6 +18,7 @@
  */
 
 #include "IOSignalModel.h"
+#include "SymbolTable.h"
 
 IOSignalModel::IOSignalModel(QObject *parent) :
     QAbstractListModel(parent)
@@ -41,13 +42,16 @@ QVariant IOSignalModel::data(const QModelIndex& index, int role) const
     if(index.row() < 0 || index.row() >= mIOSignals.count())
         return QVariant();
 
-    if(role != Qt::DisplayRole)
+    if(role != Qt::DisplayRole && role != SymbolTable::Role_Name)
         return QVariant();
 
     IOSignal *sig = mIOSignals.at(index.row());
     if(!sig)
         return QVariant();
 
+    if(role == SymbolTable::Role_Name)
+        return sig->name();
+
     return sig->declaration();
 }
 
@@ -69,6 +73,78 @@ void IOSignalModel::append(IOSignal *sig)
     endInsertRows();
 }
 
+void IOSignalModel::insert(int index, IOSignal *sig)
+{
+    if(contains(sig->name()))
+        return;
+
+    index = qBound(0, index, mIOSignals.count());
+
+    beginInsertRows(QModelIndex(), index, index);
+    mIOSignals.insert(index, sig);
+    mIOSignalsByName[sig->name()] = sig;
+    endInsertRows();
+}
+
+void IOSignalModel::appendMany(const QList<IOSignal*>& sigs)
+{
+    QList<IOSignal*> added;
+    added.reserve(sigs.count());
+
+    // Names go in first so duplicates within the batch are caught as well.
+    mIOSignalsByName.reserve(mIOSignalsByName.count() + sigs.count());
+
+    foreach(IOSignal *sig, sigs)
+    {
+        if(contains(sig->name()))
+        {
+            delete sig;
+            continue;
+        }
+
+        mIOSignalsByName.insert(sig->name(), sig);
+        added.append(sig);
+    }
+
+    if(added.isEmpty())
+        return;
+
+    int row = mIOSignals.count();
+
+    beginInsertRows(QModelIndex(), row, row + added.count() - 1);
+    mIOSignals.reserve(row + added.count());
+    mIOSignals.append(added);
+    endInsertRows();
+}
+
+void IOSignalModel::replaceAll(const QList<IOSignal*>& sigs)
+{
+    beginResetModel();
+
+    foreach(IOSignal *sig, mIOSignals)
+        delete sig;
+
+    mIOSignals.clear();
+    mIOSignalsByName.clear();
+
+    mIOSignals.reserve(sigs.count());
+    mIOSignalsByName.reserve(sigs.count());
+
+    foreach(IOSignal *sig, sigs)
+    {
+        if(contains(sig->name()))
+        {
+            delete sig;
+            continue;
+        }
+
+        mIOSignals.append(sig);
+        mIOSignalsByName.insert(sig->name(), sig);
+    }
+
+    endResetModel();
+}
+
 void IOSignalModel::up(int index)
 {
     if(index < 1 || index >= mIOSignals.count())
@@ -133,18 +209,10 @@ void IOSignalModel::update(int index)
     }
 
     emit dataChanged(this->index(index), this->index(index),
-        QVector<int>() << Qt::DisplayRole);
+        QVector<int>() << Qt::DisplayRole << SymbolTable::Role_Name);
 }
 
 void IOSignalModel::clear()
 {
-    beginResetModel();
-
-    foreach(IOSignal *sig, mIOSignals)
-        delete sig;
-
-    mIOSignals.clear();
-    mIOSignalsByName.clear();
-
-    endResetModel();
+    replaceAll(QList<IOSignal*>());
 }
@@ -39,6 +39,18 @@ public:
     bool contains(const QString& sigName) const;
     void append(IOSignal *sig);
 
+    /// Insert at the given row, as append() does at the end.
+    void insert(int index, IOSignal *sig);
+
+    /**
+     * Append several signals with a single insert. The model owns them
+     * afterwards and deletes any whose name is already taken.
+     */
+    void appendMany(const QList<IOSignal*>& sigs);
+
+    /// Replace every signal with a single reset. Takes ownership as above.
+    void replaceAll(const QList<IOSignal*>& sigs);
+
     void up(int index);
     void down(int index);
     void remove(int index);
@@ -20,24 +20,82 @@
 #include "MainWindow.h"
 #include "ui_MainWindow.h"
 
+#include "GenerationCache.h"
+#include "ProjectCommand.h"
+#include "TransitionGraph.h"
+#include "VerilogGenerator.h"
+#include "SymbolTable.h"
 #include "VerilogHighlighter.h"
 
-#include <cmath>
+#include <QtConcurrent/QtConcurrentRun>
 
+#include <QtCore/QBuffer>
 #include <QtCore/QRegExp>
 #include <QtCore/QSettings>
 
 #include <QtWidgets/QMessageBox>
+#include <QtWidgets/QUndoStack>
 #include <QtWidgets/QFileDialog>
 #include <QtWidgets/QInputDialog>
-
-#include <QtXml/QDomDocument>
-#include <QtXml/QDomElement>
+#include <QtWidgets/QProgressBar>
+#include <QtWidgets/QPushButton>
 
 #include <iostream>
 
+/**
+ * Generate the module for a snapshot of the project and compare it with
+ * the file on disk. This runs on a worker thread and never touches the
+ * window.
+ */
+static GenerateResult generateModule(const Project& project,
+    const QString& path, QSharedPointer<QAtomicInt> cancel)
+{
+    GenerateResult result;
+    result.path = path;
+    result.cancelled = false;
+    result.unchanged = false;
+    result.written = false;
+    result.failed = false;
+
+    if(project.language() == Project::Language_VHDL)
+        result.data = MainWindow::GenerateVHDL(project, cancel.data());
+    else
+        result.data = MainWindow::GenerateVerilog(project, cancel.data());
+
+    if(cancel->load())
+    {
+        result.cancelled = true;
+        return result;
+    }
+
+    result.key = GenerationCache::key(project);
+
+    // Leave the module and its time stamp alone if nothing changed, but
+    // note that it now goes with this project.
+    result.unchanged = GenerationCache::matches(path, result.data);
+
+    if(result.unchanged)
+        GenerationCache::store(result.key, path, result.data);
+
+    return result;
+}
+
+/// Write a module generateModule() produced, also on a worker thread.
+static GenerateResult writeModule(GenerateResult result)
+{
+    result.written = true;
+    result.failed = GenerationCache::writeIfChanged(result.path,
+        result.data) == GenerationCache::Status_Failed;
+
+    // Keep the batch generator from trusting an older sidecar.
+    if(!result.failed)
+        GenerationCache::store(result.key, result.path, result.data);
+
+    return result;
+}
+
 MainWindow::MainWindow(QWidget *parent) :
-    QMainWindow(parent),
+    QMainWindow(parent), mRecordChanges(false),
     ui(new Ui::MainWindow)
 {
     QFile templateFile(":/template.xml");
@@ -50,6 +108,11 @@ MainWindow::MainWindow(QWidget *parent) :
     mControlSignalModel = new ControlSignalModel();
     mStateModel = new StateModel();
 
+    mSymbolTable = new SymbolTable(this);
+    mSymbolTable->addModel(mIOSignalModel, SymbolTable::Kind_Signal);
+    mSymbolTable->addModel(mControlSignalModel, SymbolTable::Kind_Signal);
+    mSymbolTable->addModel(mStateModel, SymbolTable::Kind_State);
+
     ui->setupUi(this);
     ui->ioList->setModel(mIOSignalModel);
     ui->controlList->setModel(mControlSignalModel);
@@ -58,10 +121,22 @@ MainWindow::MainWindow(QWidget *parent) :
     ui->stateList->setModel(mStateModel);
     ui->stateReset->setModel(mStateModel);
 
-    /// @todo Use these?
+    /// @todo Use this?
     ui->mainToolBar->hide();
+
+    // The status bar only shows while a generate runs in the background.
     ui->statusBar->hide();
 
+    mGenerateProgress = new QProgressBar(this);
+    mGenerateProgress->setRange(0, 0);
+    mGenerateProgress->setMaximumWidth(150);
+    ui->statusBar->addPermanentWidget(mGenerateProgress);
+
+    mGenerateCancelButton = new QPushButton(tr("Cancel"), this);
+    ui->statusBar->addPermanentWidget(mGenerateCancelButton);
+
+    mGenerateWatcher = new QFutureWatcher<GenerateResult>(this);
+
     /// @todo Add VHDL support.
     ui->outputLang->removeItem(1);
 
@@ -87,18 +162,22 @@ MainWindow::MainWindow(QWidget *parent) :
     ui->instCode->setPalette(codePalette);
     ui->stateDefaultsCode->setPalette(codePalette);
 
-    new VerilogHighlighter(ui->dataCode->document());
-    new VerilogHighlighter(ui->taskCode->document());
-    new VerilogHighlighter(ui->headerCode->document());
-    new VerilogHighlighter(ui->stateCode->document());
-    new VerilogHighlighter(ui->instCode->document());
-    new VerilogHighlighter(ui->stateDefaultsCode->document());
+    new VerilogHighlighter(ui->dataCode, mSymbolTable);
+    new VerilogHighlighter(ui->taskCode, mSymbolTable);
+    new VerilogHighlighter(ui->headerCode, mSymbolTable);
+    new VerilogHighlighter(ui->stateCode, mSymbolTable);
+    new VerilogHighlighter(ui->instCode, mSymbolTable);
+    new VerilogHighlighter(ui->stateDefaultsCode, mSymbolTable);
 
     connect(ui->actionSave, SIGNAL(triggered()), this, SLOT(Save()));
     connect(ui->actionLoad, SIGNAL(triggered()), this, SLOT(Load()));
     connect(ui->actionNew, SIGNAL(triggered()), this, SLOT(New()));
     connect(ui->actionAbout, SIGNAL(triggered()), this, SLOT(About()));
     connect(ui->generate, SIGNAL(clicked()), this, SLOT(Generate()));
+    connect(mGenerateWatcher, SIGNAL(finished()),
+        this, SLOT(generateFinished()));
+    connect(mGenerateCancelButton, SIGNAL(clicked()),
+        this, SLOT(generateCancel()));
     connect(ui->actionSaveTemplate, SIGNAL(triggered()),
         this, SLOT(SaveTemplate()));
 
@@ -136,11 +215,15 @@ MainWindow::MainWindow(QWidget *parent) :
         this, SLOT(controlListRename()));
     connect(ui->controlList->selectionModel(), SIGNAL(selectionChanged(
         QItemSelection,QItemSelection)), this, SLOT(controlListChanged()));
+    connect(ui->controlRegistered, SIGNAL(toggled(bool)),
+        this, SLOT(controlListUpdate()));
 
     connect(ui->stateName, SIGNAL(textChanged(QString)),
         this, SLOT(stateListUpdate()));
     connect(ui->stateCode, SIGNAL(textChanged()),
             this, SLOT(stateListUpdate()));
+    connect(ui->stateValue, SIGNAL(valueChanged(int)),
+        this, SLOT(stateListUpdate()));
 
     connect(ui->stateListAdd, SIGNAL(clicked()),
         this, SLOT(stateListAdd()));
@@ -153,8 +236,43 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(ui->stateList->selectionModel(), SIGNAL(selectionChanged(
         QItemSelection,QItemSelection)), this, SLOT(stateListChanged()));
 
-    // Let it load the template without a dialog box.
-    mCleanXml = SaveXml();
+    QList<QComboBox*> optionCombos;
+    optionCombos << ui->clockSignal << ui->resetSignal << ui->resetType
+        << ui->stateReset << ui->outputLang << ui->stateEncoding
+        << ui->stateTarget << ui->indentType;
+
+    foreach(QComboBox *combo, optionCombos)
+    {
+        connect(combo, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(optionsChanged()));
+    }
+
+    QList<QCheckBox*> optionChecks;
+    optionChecks << ui->asciiStates << ui->defaultNettype
+        << ui->removeUnreachable << ui->mergeEquivalent;
+
+    foreach(QCheckBox *check, optionChecks)
+        connect(check, SIGNAL(toggled(bool)), this, SLOT(optionsChanged()));
+
+    connect(ui->indentValue, SIGNAL(valueChanged(int)),
+        this, SLOT(optionsChanged()));
+
+    mCodeEdits << ui->dataCode << ui->headerCode << ui->taskCode
+        << ui->stateDefaultsCode;
+
+    foreach(QPlainTextEdit *edit, mCodeEdits)
+        connect(edit, SIGNAL(textChanged()), this, SLOT(codeChanged()));
+
+    mUndoStack = new QUndoStack(this);
+    mUndoStack->setUndoLimit(100);
+
+    QAction *undo = mUndoStack->createUndoAction(this);
+    undo->setShortcut(QKeySequence::Undo);
+    ui->menuEdit->addAction(undo);
+
+    QAction *redo = mUndoStack->createRedoAction(this);
+    redo->setShortcut(QKeySequence::Redo);
+    ui->menuEdit->addAction(redo);
 
     New();
 
@@ -165,6 +283,12 @@ MainWindow::MainWindow(QWidget *parent) :
 
 MainWindow::~MainWindow()
 {
+    // The worker only holds its own snapshot, but let a write finish.
+    if(mGenerateCancel)
+        mGenerateCancel->storeRelease(1);
+
+    mGenerateWatcher->waitForFinished();
+
     delete ui;
 }
 
@@ -179,23 +303,20 @@ void MainWindow::Save()
     if(mProjectPath.isEmpty())
     {
         QString path = QFileDialog::getSaveFileName(this, tr("Save Project"),
-            QString(), tr("State of Flux FSM (*.fsm)"));
+            QString(), tr("State of Flux FSM (*.fsm);;State of Flux Binary FSM (*.fsmb)"));
         if(path.isEmpty())
             return;
 
         mProjectPath = path;
     }
 
-    QFile project(mProjectPath);
-    if(!project.open(QIODevice::WriteOnly) || !project.write(SaveXml().toUtf8()))
+    if(!project().save(mProjectPath))
     {
         QMessageBox::critical(this, tr("Save Failed"), tr("Failed to save the project."));
         return;
     }
 
-    mCleanXml = SaveXml();
-
-    project.close();
+    mUndoStack->setClean();
 
     setWindowTitle(tr("State of Flux - HDL FSM Made Easy [%1]").arg(QFileInfo(mProjectPath).baseName()));
 }
@@ -203,7 +324,7 @@ void MainWindow::Save()
 void MainWindow::closeEvent(QCloseEvent *evt)
 {
     // Check for saving.
-    if(mCleanXml != SaveXml())
+    if(!mUndoStack->isClean())
     {
         int button = QMessageBox::question(this, tr("Save Project?"),
             tr("The project has unsaved changes. Save first?"),
@@ -219,7 +340,7 @@ void MainWindow::closeEvent(QCloseEvent *evt)
             if(mProjectPath.isEmpty())
             {
                 QString path = QFileDialog::getSaveFileName(this, tr("Save Project"),
-                    QString(), tr("State of Flux FSM (*.fsm)"));
+                    QString(), tr("State of Flux FSM (*.fsm);;State of Flux Binary FSM (*.fsmb)"));
                 if(path.isEmpty())
                 {
                     evt->ignore();
@@ -229,17 +350,14 @@ void MainWindow::closeEvent(QCloseEvent *evt)
                 mProjectPath = path;
             }
 
-            QFile project(mProjectPath);
-            if(!project.open(QIODevice::WriteOnly) || !project.write(SaveXml().toUtf8()))
+            if(!project().save(mProjectPath))
             {
                 QMessageBox::critical(this, tr("Save Failed"), tr("Failed to save the project."));
                 evt->ignore();
                 return;
             }
 
-            mCleanXml = SaveXml();
-
-            project.close();
+            mUndoStack->setClean();
         }
     }
 
@@ -253,7 +371,7 @@ void MainWindow::closeEvent(QCloseEvent *evt)
 void MainWindow::New()
 {
     // Check for saving.
-    if(mCleanXml != SaveXml())
+    if(!mUndoStack->isClean())
     {
         int button = QMessageBox::question(this, tr("Save Project?"),
             tr("The project has unsaved changes. Save first?"),
@@ -266,23 +384,20 @@ void MainWindow::New()
             if(mProjectPath.isEmpty())
             {
                 QString path = QFileDialog::getSaveFileName(this, tr("Save Project"),
-                    QString(), tr("State of Flux FSM (*.fsm)"));
+                    QString(), tr("State of Flux FSM (*.fsm);;State of Flux Binary FSM (*.fsmb)"));
                 if(path.isEmpty())
                     return;
 
                 mProjectPath = path;
             }
 
-            QFile project(mProjectPath);
-            if(!project.open(QIODevice::WriteOnly) || !project.write(SaveXml().toUtf8()))
+            if(!project().save(mProjectPath))
             {
                 QMessageBox::critical(this, tr("Save Failed"), tr("Failed to save the project."));
                 return;
             }
 
-            mCleanXml = SaveXml();
-
-            project.close();
+            mUndoStack->setClean();
         }
     }
 
@@ -299,236 +414,274 @@ void MainWindow::New()
 void MainWindow::Load()
 {
     QString path = QFileDialog::getOpenFileName(this, tr("Load Project"),
-        QString(), tr("State of Flux FSM (*.fsm)"));
+        QString(), tr("State of Flux FSM (*.fsm);;State of Flux Binary FSM (*.fsmb)"));
     if(path.isEmpty())
         return;
 
     mProjectPath = path;
 
-    QString xml;
-    QFile project(mProjectPath);
-    if(!project.open(QIODevice::ReadOnly) || (xml = QString::fromUtf8(project.readAll())).isEmpty())
+    Project proj;
+    if(!proj.load(mProjectPath))
     {
         QMessageBox::critical(this, tr("Load Failed"), tr("Failed to load the project."));
         return;
     }
 
-    project.close();
-
-    LoadXml(xml);
+    loadProject(proj);
 
     setWindowTitle(tr("State of Flux - HDL FSM Made Easy [%1]").arg(QFileInfo(mProjectPath).baseName()));
 }
 
-QString MainWindow::SaveXml()
+Project MainWindow::project() const
 {
-    QDomDocument doc;
-
-    // Create the root element.
-    QDomElement root = doc.createElement("state_of_flux");
-    doc.appendChild(root);
+    Project proj = options();
 
+    QList<IOSignal> ioSignals;
     for(int i = 0; i < mIOSignalModel->rowCount(); i++)
-        root.appendChild(mIOSignalModel->at(i)->toXml(doc));
+        ioSignals.append(*mIOSignalModel->at(i));
+    proj.setIOSignals(ioSignals);
 
+    QList<ControlSignal> controlSignals;
     for(int i = 0; i < mControlSignalModel->rowCount(); i++)
-        root.appendChild(mControlSignalModel->at(i)->toXml(doc));
+        controlSignals.append(*mControlSignalModel->at(i));
+    proj.setControlSignals(controlSignals);
 
+    QList<State> states;
     for(int i = 0; i < mStateModel->rowCount(); i++)
-        root.appendChild(mStateModel->at(i)->toXml(doc));
+        states.append(*mStateModel->at(i));
+    proj.setStates(states);
 
-    QDomElement clockSignal = doc.createElement("clock");
-    clockSignal.setAttribute("signal", ui->clockSignal->currentText());
-    root.appendChild(clockSignal);
+    proj.setDatapathCode(ui->dataCode->toPlainText());
+    proj.setHeaderCode(ui->headerCode->toPlainText());
+    proj.setTaskCode(ui->taskCode->toPlainText());
+    proj.setStateDefaultsCode(ui->stateDefaultsCode->toPlainText());
 
-    QDomElement resetSignal = doc.createElement("reset");
-    resetSignal.setAttribute("signal", ui->resetSignal->currentText());
-    root.appendChild(resetSignal);
+    return proj;
+}
+
+Project MainWindow::options() const
+{
+    Project proj;
+    proj.setName(QFileInfo(mProjectPath).baseName());
+
+    proj.setClockSignal(ui->clockSignal->currentText());
+    proj.setResetSignal(ui->resetSignal->currentText());
 
     switch(ui->resetType->currentIndex())
     {
     case 0:
-        resetSignal.setAttribute("type", "async");
+        proj.setResetType(Project::ResetType_Async);
         break;
     default:
-        resetSignal.setAttribute("type", "sync");
+        proj.setResetType(Project::ResetType_Sync);
         break;
     }
 
-    QDomElement options = doc.createElement("options");
-    options.setAttribute("ascii_states", ui->asciiStates->isChecked());
-    options.setAttribute("default_nettype", ui->defaultNettype->isChecked());
-    options.setAttribute("language", ui->outputLang->currentText().toLower());
-    options.setAttribute("indent_type", ui->indentType->currentText().toLower());
-    options.setAttribute("indent_size", ui->indentValue->value());
-    root.appendChild(options);
+    proj.setResetState(ui->stateReset->currentText());
 
-    QDomElement datapath = doc.createElement("datapath");
-    datapath.appendChild(doc.createCDATASection(ui->dataCode->toPlainText()));
-    root.appendChild(datapath);
+    proj.setAsciiStates(ui->asciiStates->isChecked());
+    proj.setDefaultNettype(ui->defaultNettype->isChecked());
+    proj.setRemoveUnreachable(ui->removeUnreachable->isChecked());
+    proj.setMergeEquivalent(ui->mergeEquivalent->isChecked());
+    // Go by the text as items may have been removed from the combo.
+    QString language = ui->outputLang->currentText().toLower();
 
-    QDomElement header = doc.createElement("header");
-    header.appendChild(doc.createCDATASection(ui->headerCode->toPlainText()));
-    root.appendChild(header);
+    if(language == "vhdl")
+        proj.setLanguage(Project::Language_VHDL);
+    else if(language == "systemverilog")
+        proj.setLanguage(Project::Language_SystemVerilog);
+    else
+        proj.setLanguage(Project::Language_Verilog);
+    proj.setEncoding((Project::Encoding)qMax(0, ui->stateEncoding->currentIndex()));
+    proj.setTarget(ui->stateTarget->currentIndex() == 1 ?
+        Project::Target_ASIC : Project::Target_FPGA);
+    proj.setIndentType(ui->indentType->currentIndex() == 1 ?
+        Project::IndentType_Tabs : Project::IndentType_Spaces);
+    proj.setIndentSize(ui->indentValue->value());
+
+    return proj;
+}
 
-    QDomElement tasks = doc.createElement("tasks");
-    tasks.appendChild(doc.createCDATASection(ui->taskCode->toPlainText()));
-    root.appendChild(tasks);
+void MainWindow::setProject(const Project& proj)
+{
+    // Swap each model's contents in one reset so the views only lay out
+    // once no matter how many entries the project has.
+    QList<IOSignal> ioSignals = proj.ioSignals();
+    QList<IOSignal*> ioSignalObjs;
+    ioSignalObjs.reserve(ioSignals.count());
+
+    foreach(const IOSignal& sig, ioSignals)
+        ioSignalObjs.append(new IOSignal(sig));
 
-    QDomElement stateDefaults = doc.createElement("state_defaults");
-    stateDefaults.appendChild(doc.createCDATASection(ui->stateDefaultsCode->toPlainText()));
-    root.appendChild(stateDefaults);
+    mIOSignalModel->replaceAll(ioSignalObjs);
+    ioListChanged();
 
-    QDomElement resetState = doc.createElement("reset_state");
-    resetState.setAttribute("state", ui->stateReset->currentText());
-    root.appendChild(resetState);
+    QList<ControlSignal> controlSignals = proj.controlSignals();
+    QList<ControlSignal*> controlSignalObjs;
+    controlSignalObjs.reserve(controlSignals.count());
 
-    QString xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n" +
-        doc.toString();
+    foreach(const ControlSignal& sig, controlSignals)
+        controlSignalObjs.append(new ControlSignal(sig));
+
+    mControlSignalModel->replaceAll(controlSignalObjs);
+    controlListChanged();
 
-    // std::cout << xml.toUtf8().constData() << std::endl;
+    QList<State> states = proj.states();
+    QList<State*> stateObjs;
+    stateObjs.reserve(states.count());
 
-    return xml;
+    foreach(const State& state, states)
+        stateObjs.append(new State(state));
+
+    mStateModel->replaceAll(stateObjs);
+    stateListChanged();
+
+    setOptions(proj);
+
+    ui->dataCode->setPlainText(proj.datapathCode());
+    ui->headerCode->setPlainText(proj.headerCode());
+    ui->taskCode->setPlainText(proj.taskCode());
+    ui->stateDefaultsCode->setPlainText(proj.stateDefaultsCode());
 }
 
-void MainWindow::LoadXml(const QString& xml)
+void MainWindow::setOptions(const Project& proj)
 {
-    // std::cout << xml.toUtf8().constData() << std::endl;
+    if(proj.clockSignal().isEmpty())
+        ui->clockSignal->setCurrentIndex(0);
+    else
+        ui->clockSignal->setCurrentText(proj.clockSignal());
 
-    // Clear the models first.
-    mIOSignalModel->clear();
-    mControlSignalModel->clear();
-    mStateModel->clear();
+    if(proj.resetSignal().isEmpty())
+        ui->resetSignal->setCurrentIndex(0);
+    else
+        ui->resetSignal->setCurrentText(proj.resetSignal());
+
+    ui->resetType->setCurrentIndex(
+        proj.resetType() == Project::ResetType_Sync ? 1 : 0);
+
+    ui->asciiStates->setChecked(proj.asciiStates());
+    ui->defaultNettype->setChecked(proj.defaultNettype());
+    ui->removeUnreachable->setChecked(proj.removeUnreachable());
+    ui->mergeEquivalent->setChecked(proj.mergeEquivalent());
+    QString language = "Verilog";
+
+    if(proj.language() == Project::Language_VHDL)
+        language = "VHDL";
+    else if(proj.language() == Project::Language_SystemVerilog)
+        language = "SystemVerilog";
+
+    ui->outputLang->setCurrentIndex(qMax(0,
+        ui->outputLang->findText(language)));
+    ui->stateEncoding->setCurrentIndex(proj.encoding());
+    ui->stateTarget->setCurrentIndex(
+        proj.target() == Project::Target_ASIC ? 1 : 0);
+    ui->indentType->setCurrentIndex(
+        proj.indentType() == Project::IndentType_Tabs ? 1 : 0);
+    ui->indentValue->setValue(proj.indentSize());
+
+    ui->stateReset->setCurrentText(proj.resetState());
+}
 
-    QDomDocument doc;
-    doc.setContent(xml);
+void MainWindow::setCode(const QString& editor, const QString& code)
+{
+    foreach(QPlainTextEdit *edit, mCodeEdits)
+    {
+        if(edit->objectName() == editor)
+        {
+            edit->setPlainText(code);
+            mCurrentCode[editor] = code;
+        }
+    }
+}
 
-    QDomElement root = doc.documentElement();
+QString MainWindow::SaveXml()
+{
+    return project().toXml();
+}
 
-    QDomNodeList nodes = root.elementsByTagName("io_signal");
+void MainWindow::LoadXml(const QString& xml)
+{
+    // A document that fails to parse loads as an empty project.
+    Project proj;
+    if(!proj.fromXml(xml))
+        proj = Project();
 
-    for(int i = 0; i < nodes.count(); i++)
-        mIOSignalModel->append(IOSignal::fromXml(nodes.at(i).toElement()));
+    loadProject(proj);
+}
 
-    ioListChanged();
+void MainWindow::loadProject(const Project& proj)
+{
+    mRecordChanges = false;
+    setProject(proj);
+    mRecordChanges = true;
 
-    nodes = root.elementsByTagName("control_signal");
+    // The widgets may have adjusted the project (e.g. the clock) so take
+    // the clean state from what they show.
+    mCurrentOptions = options();
+    mCurrentCode.clear();
 
-    for(int i = 0; i < nodes.count(); i++)
-        mControlSignalModel->append(ControlSignal::fromXml(nodes.at(i).toElement()));
+    foreach(QPlainTextEdit *edit, mCodeEdits)
+        mCurrentCode.insert(edit->objectName(), edit->toPlainText());
 
-    controlListChanged();
+    mUndoStack->clear();
+}
 
-    nodes = root.elementsByTagName("state");
+void MainWindow::beginRestore()
+{
+    mRecordChanges = false;
+}
 
-    for(int i = 0; i < nodes.count(); i++)
-        mStateModel->append(State::fromXml(nodes.at(i).toElement()));
+void MainWindow::endRestore()
+{
+    mRecordChanges = true;
 
+    // Rows may have come or gone under the selection, and the combos
+    // follow the lists.
+    ioListChanged();
+    controlListChanged();
     stateListChanged();
 
-    nodes = root.elementsByTagName("clock");
-    if(nodes.count())
-    {
-        QDomElement clockSignal = nodes.at(0).toElement();
-        ui->clockSignal->setCurrentText(clockSignal.attribute("signal"));
-    }
-    else
-    {
-        ui->clockSignal->setCurrentIndex(0);
-    }
-
-    nodes = root.elementsByTagName("reset");
-    if(nodes.count())
-    {
-        QDomElement resetSignal = nodes.at(0).toElement();
-        ui->resetSignal->setCurrentText(resetSignal.attribute("signal"));
+    mCurrentOptions = options();
+}
 
-        if(resetSignal.attribute("type").toLower().trimmed() == "sync")
-            ui->resetType->setCurrentIndex(1);
-        else
-            ui->resetType->setCurrentIndex(0);
-    }
-    else
+void MainWindow::recordChange(ProjectCommand *cmd)
+{
+    if(!mRecordChanges)
     {
-        ui->resetSignal->setCurrentIndex(0);
-        ui->resetType->setCurrentIndex(0);
+        delete cmd;
+        return;
     }
 
-    nodes = root.elementsByTagName("options");
-    if(nodes.count())
-    {
-        QDomElement options = nodes.at(0).toElement();
-        ui->asciiStates->setChecked(options.attribute("ascii_states").toInt());
-        ui->defaultNettype->setChecked(options.attribute("default_nettype").toInt());
-        ui->outputLang->setCurrentIndex(options.attribute("language").toLower().trimmed() == "vhdl" ? 1 : 0);
-        ui->indentType->setCurrentIndex(options.attribute("indent_type").toLower().trimmed() == "tabs" ? 1 : 0);
-        ui->indentValue->setValue(options.attribute("indent_size").toInt());
-    }
-    else
-    {
-        ui->asciiStates->setChecked(true);
-        ui->defaultNettype->setChecked(true);
-        ui->outputLang->setCurrentIndex(0);
-        ui->indentType->setCurrentIndex(0);
-        ui->indentValue->setValue(2);
-    }
+    mUndoStack->push(cmd);
+}
 
-    nodes = root.elementsByTagName("datapath");
-    if(nodes.count())
-    {
-        QDomElement datapath = nodes.at(0).toElement();
-        ui->dataCode->setPlainText(datapath.text());
-    }
-    else
-    {
-        ui->dataCode->clear();
-    }
+void MainWindow::optionsChanged()
+{
+    if(!mRecordChanges)
+        return;
 
-    nodes = root.elementsByTagName("header");
-    if(nodes.count())
-    {
-        QDomElement header = nodes.at(0).toElement();
-        ui->headerCode->setPlainText(header.text());
-    }
-    else
-    {
-        ui->headerCode->clear();
-    }
+    // A combo following a list can change index without changing text.
+    Project after = options();
+    if(after.hash() == mCurrentOptions.hash())
+        return;
 
-    nodes = root.elementsByTagName("tasks");
-    if(nodes.count())
-    {
-        QDomElement tasks = nodes.at(0).toElement();
-        ui->taskCode->setPlainText(tasks.text());
-    }
-    else
-    {
-        ui->taskCode->clear();
-    }
+    recordChange(new OptionsCommand(this, mCurrentOptions, after,
+        tr("Change Options"), sender()->objectName()));
+    mCurrentOptions = after;
+}
 
-    nodes = root.elementsByTagName("state_defaults");
-    if(nodes.count())
-    {
-        QDomElement stateDefaults = nodes.at(0).toElement();
-        ui->stateDefaultsCode->setPlainText(stateDefaults.text());
-    }
-    else
-    {
-        ui->stateDefaultsCode->clear();
-    }
+void MainWindow::codeChanged()
+{
+    QPlainTextEdit *edit = qobject_cast<QPlainTextEdit*>(sender());
+    if(!edit || !mRecordChanges)
+        return;
 
-    nodes = root.elementsByTagName("reset_state");
-    if(nodes.count())
-    {
-        QDomElement resetState = nodes.at(0).toElement();
-        ui->stateReset->setCurrentText(resetState.attribute("state"));
-    }
-    else
-    {
-        ui->stateReset->clear();
-    }
+    QString editor = edit->objectName();
+    QString code = edit->toPlainText();
 
-    mCleanXml = SaveXml();
+    recordChange(new CodeCommand(this, editor, mCurrentCode.value(editor),
+        code, tr("Edit Code")));
+    mCurrentCode[editor] = code;
 }
 
 bool MainWindow::signalExists(const QString& sigName) const
@@ -539,263 +692,6 @@ bool MainWindow::signalExists(const QString& sigName) const
         mStateModel->contains(sigName);
 }
 
-bool MainWindow::validIdentifier(const QString& ident)
-{
-    // Use the SystemVerilog keywords list as there are more.
-    static QRegExp identRegExp("([a-zA-Z_][a-zA-Z0-9_$]*|\\\\[^ \t\f\r]+)");
-    static QStringList keywords(QStringList()
-        << QString("accept_on")
-        << QString("alias")
-        << QString("always")
-        << QString("always_comb")
-        << QString("always_ff")
-        << QString("always_latch")
-        << QString("and")
-        << QString("assert")
-        << QString("assign")
-        << QString("assume")
-        << QString("automatic")
-        << QString("before")
-        << QString("begin")
-        << QString("bind")
-        << QString("bins")
-        << QString("binsof")
-        << QString("bit")
-        << QString("break")
-        << QString("buf")
-        << QString("bufif0")
-        << QString("bufif1")
-        << QString("byte")
-        << QString("case")
-        << QString("casex")
-        << QString("casez")
-        << QString("cell")
-        << QString("chandle")
-        << QString("checker")
-        << QString("class")
-        << QString("clocking")
-        << QString("cmos")
-        << QString("config")
-        << QString("const")
-        << QString("constraint")
-        << QString("context")
-        << QString("continue")
-        << QString("cover")
-        << QString("covergroup")
-        << QString("coverpoint")
-        << QString("cross")
-        << QString("deassign")
-        << QString("default")
-        << QString("defparam")
-        << QString("design")
-        << QString("disable")
-        << QString("dist")
-        << QString("do")
-        << QString("edge")
-        << QString("else")
-        << QString("end")
-        << QString("endcase")
-        << QString("endchecker")
-        << QString("endclass")
-        << QString("endclocking")
-        << QString("endconfig")
-        << QString("endfunction")
-        << QString("endgenerate")
-        << QString("endgroup")
-        << QString("endinterface")
-        << QString("endmodule")
-        << QString("endpackage")
-        << QString("endprimitive")
-        << QString("endprogram")
-        << QString("endproperty")
-        << QString("endspecify")
-        << QString("endsequence")
-        << QString("endtable")
-        << QString("endtask")
-        << QString("enum")
-        << QString("event")
-        << QString("eventually")
-        << QString("expect")
-        << QString("export")
-        << QString("extends")
-        << QString("extern")
-        << QString("final")
-        << QString("first_match")
-        << QString("for")
-        << QString("force")
-        << QString("foreach")
-        << QString("forever")
-        << QString("fork")
-        << QString("forkjoin")
-        << QString("function")
-        << QString("generate")
-        << QString("genvar")
-        << QString("global")
-        << QString("highz0")
-        << QString("highz1")
-        << QString("if")
-        << QString("iff")
-        << QString("ifnone")
-        << QString("ignore_bins")
-        << QString("illegal_bins")
-        << QString("implements")
-        << QString("implies")
-        << QString("import")
-        << QString("incdir")
-        << QString("include")
-        << QString("initial")
-        << QString("inout")
-        << QString("input")
-        << QString("inside")
-        << QString("instance")
-        << QString("int")
-        << QString("integer")
-        << QString("interconnect")
-        << QString("interface")
-        << QString("intersect")
-        << QString("join")
-        << QString("join_any")
-        << QString("join_none")
-        << QString("large")
-        << QString("let")
-        << QString("liblist")
-        << QString("library")
-        << QString("local")
-        << QString("localparam")
-        << QString("logic")
-        << QString("longint")
-        << QString("macromodule")
-        << QString("matches")
-        << QString("medium")
-        << QString("modport")
-        << QString("module")
-        << QString("nand")
-        << QString("negedge")
-        << QString("nettype")
-        << QString("new")
-        << QString("nexttime")
-        << QString("nmos")
-        << QString("nor")
-        << QString("noshowcancelled")
-        << QString("not")
-        << QString("notif0")
-        << QString("notif1")
-        << QString("null")
-        << QString("or")
-        << QString("output")
-        << QString("package")
-        << QString("packed")
-        << QString("parameter")
-        << QString("pmos")
-        << QString("posedge")
-        << QString("primitive")
-        << QString("priority")
-        << QString("program")
-        << QString("property")
-        << QString("protected")
-        << QString("pull0")
-        << QString("pull1")
-        << QString("pulldown")
-        << QString("pullup")
-        << QString("pulsestyle_ondetect")
-        << QString("pulsestyle_onevent")
-        << QString("pure")
-        << QString("rand")
-        << QString("randc")
-        << QString("randcase")
-        << QString("randsequence")
-        << QString("rcmos")
-        << QString("real")
-        << QString("realtime")
-        << QString("ref")
-        << QString("reg")
-        << QString("reject_on")
-        << QString("release")
-        << QString("repeat")
-        << QString("restrict")
-        << QString("return")
-        << QString("rnmos")
-        << QString("rpmos")
-        << QString("rtran")
-        << QString("rtranif0")
-        << QString("rtranif1")
-        << QString("s_always")
-        << QString("s_eventually")
-        << QString("s_nexttime")
-        << QString("s_until")
-        << QString("s_until_with")
-        << QString("scalared")
-        << QString("sequence")
-        << QString("shortint")
-        << QString("shortreal")
-        << QString("showcancelled")
-        << QString("signed")
-        << QString("small")
-        << QString("soft")
-        << QString("solve")
-        << QString("specify")
-        << QString("specparam")
-        << QString("static")
-        << QString("string")
-        << QString("strong")
-        << QString("strong0")
-        << QString("strong1")
-        << QString("struct")
-        << QString("super")
-        << QString("supply0")
-        << QString("supply1")
-        << QString("sync_accept_on")
-        << QString("sync_reject_on")
-        << QString("table")
-        << QString("tagged")
-        << QString("task")
-        << QString("this")
-        << QString("throughout")
-        << QString("time")
-        << QString("timeprecision")
-        << QString("timeunit")
-        << QString("tran")
-        << QString("tranif0")
-        << QString("tranif1")
-        << QString("tri")
-        << QString("tri0")
-        << QString("tri1")
-        << QString("triand")
-        << QString("trior")
-        << QString("trireg")
-        << QString("type")
-        << QString("typedef")
-        << QString("union")
-        << QString("unique")
-        << QString("unique0")
-        << QString("unsigned")
-        << QString("until")
-        << QString("until_with")
-        << QString("untyped")
-        << QString("use")
-        << QString("uwire")
-        << QString("var")
-        << QString("vectored")
-        << QString("virtual")
-        << QString("void")
-        << QString("wait")
-        << QString("wait_order")
-        << QString("wand")
-        << QString("weak")
-        << QString("weak0")
-        << QString("weak1")
-        << QString("while")
-        << QString("wildcard")
-        << QString("wire")
-        << QString("with")
-        << QString("within")
-        << QString("wor")
-        << QString("xnor")
-        << QString("xor"));
-
-    return !keywords.contains(ident) && identRegExp.exactMatch(ident);
-}
-
 void MainWindow::ioListAdd()
 {
     QString sigName;
@@ -823,7 +719,7 @@ void MainWindow::ioListAdd()
             return;
 
         // See if the signal name is valid.
-        if(!validIdentifier(sigName))
+        if(!VerilogSignal::validIdentifier(sigName))
         {
             QMessageBox::critical(this, tr("Invalid Signal Name"),
                 tr("A signal named \"%1\" is not valid. "
@@ -839,8 +735,17 @@ void MainWindow::ioListAdd()
     sigObj->setType(IOSignal::Type_Wire);
     sigObj->setSize(1);
 
+    // The clock and reset combos may pick up the signal as well.
+    mUndoStack->beginMacro(tr("Add Signal"));
+
     mIOSignalModel->append(sigObj);
     ioListChanged();
+
+    recordChange(new IOSignalCommand(this, mIOSignalModel,
+        ProjectCommand::Action_Insert, mIOSignalModel->rowCount() - 1,
+        IOSignal(), *sigObj, tr("Add Signal")));
+
+    mUndoStack->endMacro();
 }
 
 void MainWindow::ioListUp()
@@ -849,8 +754,14 @@ void MainWindow::ioListUp()
     if(rows.isEmpty())
         return;
 
-    mIOSignalModel->up(rows.first().row());
+    int row = rows.first().row();
+
+    mIOSignalModel->up(row);
     ioListChanged();
+
+    recordChange(new IOSignalCommand(this, mIOSignalModel,
+        ProjectCommand::Action_Up, row, IOSignal(), IOSignal(),
+        tr("Move Signal")));
 }
 
 void MainWindow::ioListDown()
@@ -859,8 +770,14 @@ void MainWindow::ioListDown()
     if(rows.isEmpty())
         return;
 
-    mIOSignalModel->down(rows.first().row());
+    int row = rows.first().row();
+
+    mIOSignalModel->down(row);
     ioListChanged();
+
+    recordChange(new IOSignalCommand(this, mIOSignalModel,
+        ProjectCommand::Action_Down, row, IOSignal(), IOSignal(),
+        tr("Move Signal")));
 }
 
 void MainWindow::ioListDelete()
@@ -869,8 +786,26 @@ void MainWindow::ioListDelete()
     if(rows.isEmpty())
         return;
 
-    mIOSignalModel->remove(rows.first().row());
+    int row = rows.first().row();
+
+    IOSignal *sig = mIOSignalModel->at(row);
+    if(!sig)
+        return;
+
+    IOSignal before = *sig;
+
+    // Combos following the list may move off the row.
+    mUndoStack->beginMacro(tr("Delete Signal"));
+
+    mIOSignalModel->remove(row);
+    delete sig;
     ioListChanged();
+
+    recordChange(new IOSignalCommand(this, mIOSignalModel,
+        ProjectCommand::Action_Remove, row, before, IOSignal(),
+        tr("Delete Signal")));
+
+    mUndoStack->endMacro();
 }
 
 void MainWindow::ioListChanged()
@@ -975,6 +910,8 @@ void MainWindow::ioListUpdate()
     if(!sig)
         return;
 
+    IOSignal before = *sig;
+
     sig->setName(ui->ioSignal->text());
 
     switch(ui->ioDirection->currentIndex())
@@ -1006,6 +943,10 @@ void MainWindow::ioListUpdate()
     sig->setSize(ui->ioSize->value());
     mIOSignalModel->update(row);
     instUpdate();
+
+    recordChange(new IOSignalCommand(this, mIOSignalModel,
+        ProjectCommand::Action_Edit, row, before, *sig, tr("Edit Signal"),
+        QString("io:%1").arg(row)));
 }
 
 void MainWindow::instUpdate()
@@ -1064,7 +1005,7 @@ void MainWindow::controlListAdd()
             return;
 
         // See if the signal name is valid.
-        if(!validIdentifier(sigName))
+        if(!VerilogSignal::validIdentifier(sigName))
         {
             QMessageBox::critical(this, tr("Invalid Signal Name"),
                 tr("A signal named \"%1\" is not valid. "
@@ -1079,6 +1020,10 @@ void MainWindow::controlListAdd()
 
     mControlSignalModel->append(sigObj);
     controlListChanged();
+
+    recordChange(new ControlSignalCommand(this, mControlSignalModel,
+        ProjectCommand::Action_Insert, mControlSignalModel->rowCount() - 1,
+        ControlSignal(), *sigObj, tr("Add Control Signal")));
 }
 
 void MainWindow::controlListUp()
@@ -1087,8 +1032,14 @@ void MainWindow::controlListUp()
     if(rows.isEmpty())
         return;
 
-    mControlSignalModel->up(rows.first().row());
+    int row = rows.first().row();
+
+    mControlSignalModel->up(row);
     controlListChanged();
+
+    recordChange(new ControlSignalCommand(this, mControlSignalModel,
+        ProjectCommand::Action_Up, row, ControlSignal(), ControlSignal(),
+        tr("Move Control Signal")));
 }
 
 void MainWindow::controlListDown()
@@ -1097,8 +1048,14 @@ void MainWindow::controlListDown()
     if(rows.isEmpty())
         return;
 
-    mControlSignalModel->down(rows.first().row());
+    int row = rows.first().row();
+
+    mControlSignalModel->down(row);
     controlListChanged();
+
+    recordChange(new ControlSignalCommand(this, mControlSignalModel,
+        ProjectCommand::Action_Down, row, ControlSignal(), ControlSignal(),
+        tr("Move Control Signal")));
 }
 
 void MainWindow::controlListDelete()
@@ -1107,8 +1064,21 @@ void MainWindow::controlListDelete()
     if(rows.isEmpty())
         return;
 
-    mControlSignalModel->remove(rows.first().row());
+    int row = rows.first().row();
+
+    ControlSignal *sig = mControlSignalModel->at(row);
+    if(!sig)
+        return;
+
+    ControlSignal before = *sig;
+
+    mControlSignalModel->remove(row);
+    delete sig;
     controlListChanged();
+
+    recordChange(new ControlSignalCommand(this, mControlSignalModel,
+        ProjectCommand::Action_Remove, row, before, ControlSignal(),
+        tr("Delete Control Signal")));
 }
 
 void MainWindow::controlListChanged()
@@ -1121,18 +1091,56 @@ void MainWindow::controlListChanged()
         ui->controlListDown->setEnabled(false);
         ui->controlListDelete->setEnabled(false);
         ui->controlListRename->setEnabled(false);
+        ui->controlRegistered->setEnabled(false);
+
+        bool sigRegisteredBlocked = ui->controlRegistered->blockSignals(true);
+        ui->controlRegistered->setChecked(false);
+        ui->controlRegistered->blockSignals(sigRegisteredBlocked);
     }
     else
     {
         int row = rows.first().row();
 
+        ControlSignal *sig = mControlSignalModel->at(row);
+
         ui->controlListUp->setEnabled(row > 0);
         ui->controlListDown->setEnabled(row < (mControlSignalModel->rowCount() - 1));
         ui->controlListDelete->setEnabled(true);
         ui->controlListRename->setEnabled(true);
+        ui->controlRegistered->setEnabled(true);
+
+        if(sig)
+        {
+            bool sigRegisteredBlocked = ui->controlRegistered->blockSignals(true);
+            ui->controlRegistered->setChecked(sig->registered());
+            ui->controlRegistered->blockSignals(sigRegisteredBlocked);
+        }
     }
 }
 
+void MainWindow::controlListUpdate()
+{
+    QModelIndexList rows = ui->controlList->selectionModel()->selectedRows();
+    if(rows.isEmpty())
+        return;
+
+    int row = rows.first().row();
+
+    ControlSignal *sig = mControlSignalModel->at(row);
+    if(!sig)
+        return;
+
+    ControlSignal before = *sig;
+
+    sig->setRegistered(ui->controlRegistered->isChecked());
+
+    mControlSignalModel->update(row);
+
+    recordChange(new ControlSignalCommand(this, mControlSignalModel,
+        ProjectCommand::Action_Edit, row, before, *sig,
+        tr("Edit Control Signal")));
+}
+
 void MainWindow::controlListRename()
 {
     QModelIndexList rows = ui->controlList->selectionModel()->selectedRows();
@@ -1174,7 +1182,7 @@ void MainWindow::controlListRename()
             return;
 
         // See if the signal name is valid.
-        if(!validIdentifier(sigName))
+        if(!VerilogSignal::validIdentifier(sigName))
         {
             QMessageBox::critical(this, tr("Invalid Signal Name"),
                 tr("A signal named \"%1\" is not valid. "
@@ -1184,9 +1192,15 @@ void MainWindow::controlListRename()
         }
     }while(sigName.isEmpty() || signalExists(sigName));
 
+    ControlSignal before = *sig;
+
     sig->setName(sigName);
 
     mControlSignalModel->update(row);
+
+    recordChange(new ControlSignalCommand(this, mControlSignalModel,
+        ProjectCommand::Action_Edit, row, before, *sig,
+        tr("Rename Control Signal")));
 }
 
 void MainWindow::stateListAdd()
@@ -1216,7 +1230,7 @@ void MainWindow::stateListAdd()
             return;
 
         // See if the signal name is valid.
-        if(!validIdentifier(sigName))
+        if(!VerilogSignal::validIdentifier(sigName))
         {
             QMessageBox::critical(this, tr("Invalid State Name"),
                 tr("A state named \"%1\" is not valid. "
@@ -1229,8 +1243,17 @@ void MainWindow::stateListAdd()
     State *sigObj = new State;
     sigObj->setName(sigName);
 
+    // The reset state combo may pick up the state as well.
+    mUndoStack->beginMacro(tr("Add State"));
+
     mStateModel->append(sigObj);
     stateListChanged();
+
+    recordChange(new StateCommand(this, mStateModel,
+        ProjectCommand::Action_Insert, mStateModel->rowCount() - 1,
+        State(), *sigObj, tr("Add State")));
+
+    mUndoStack->endMacro();
 }
 
 void MainWindow::stateListUp()
@@ -1239,8 +1262,14 @@ void MainWindow::stateListUp()
     if(rows.isEmpty())
         return;
 
-    mStateModel->up(rows.first().row());
+    int row = rows.first().row();
+
+    mStateModel->up(row);
     stateListChanged();
+
+    recordChange(new StateCommand(this, mStateModel,
+        ProjectCommand::Action_Up, row, State(), State(),
+        tr("Move State")));
 }
 
 void MainWindow::stateListDown()
@@ -1249,8 +1278,14 @@ void MainWindow::stateListDown()
     if(rows.isEmpty())
         return;
 
-    mStateModel->down(rows.first().row());
+    int row = rows.first().row();
+
+    mStateModel->down(row);
     stateListChanged();
+
+    recordChange(new StateCommand(this, mStateModel,
+        ProjectCommand::Action_Down, row, State(), State(),
+        tr("Move State")));
 }
 
 void MainWindow::stateListDelete()
@@ -1259,8 +1294,26 @@ void MainWindow::stateListDelete()
     if(rows.isEmpty())
         return;
 
-    mStateModel->remove(rows.first().row());
+    int row = rows.first().row();
+
+    State *sig = mStateModel->at(row);
+    if(!sig)
+        return;
+
+    State before = *sig;
+
+    // Combos following the list may move off the row.
+    mUndoStack->beginMacro(tr("Delete State"));
+
+    mStateModel->remove(row);
+    delete sig;
     stateListChanged();
+
+    recordChange(new StateCommand(this, mStateModel,
+        ProjectCommand::Action_Remove, row, before, State(),
+        tr("Delete State")));
+
+    mUndoStack->endMacro();
 }
 
 void MainWindow::stateListChanged()
@@ -1275,16 +1328,22 @@ void MainWindow::stateListChanged()
         ui->stateListDown->setEnabled(false);
         ui->stateListDelete->setEnabled(false);
         ui->stateName->setEnabled(false);
+        ui->stateValue->setEnabled(false);
         ui->stateCode->setEnabled(false);
 
         bool stateNameBlocked = ui->stateName->blockSignals(true);
+        bool stateValueBlocked = ui->stateValue->blockSignals(true);
         bool stateCodeBlocked = ui->stateCode->blockSignals(true);
 
         ui->stateName->clear();
+        ui->stateValue->setValue(-1);
         ui->stateCode->clear();
 
         ui->stateName->blockSignals(stateNameBlocked);
+        ui->stateValue->blockSignals(stateValueBlocked);
         ui->stateCode->blockSignals(stateCodeBlocked);
+
+        stateTransitionsUpdate(QString());
     }
     else
     {
@@ -1296,18 +1355,24 @@ void MainWindow::stateListChanged()
         ui->stateListDown->setEnabled(row < (mStateModel->rowCount() - 1));
         ui->stateListDelete->setEnabled(true);
         ui->stateName->setEnabled(true);
+        ui->stateValue->setEnabled(true);
         ui->stateCode->setEnabled(true);
 
         if(sig)
         {
             bool stateNameBlocked = ui->stateName->blockSignals(true);
+            bool stateValueBlocked = ui->stateValue->blockSignals(true);
             bool stateCodeBlocked = ui->stateCode->blockSignals(true);
 
             ui->stateName->setText(sig->name());
+            ui->stateValue->setValue(sig->value());
             ui->stateCode->setPlainText(sig->code());
 
             ui->stateName->blockSignals(stateNameBlocked);
+            ui->stateValue->blockSignals(stateValueBlocked);
             ui->stateCode->blockSignals(stateCodeBlocked);
+
+            stateTransitionsUpdate(sig->code());
         }
     }
 }
@@ -1324,10 +1389,42 @@ void MainWindow::stateListUpdate()
     if(!sig)
         return;
 
+    State before = *sig;
+
     sig->setName(ui->stateName->text());
+    sig->setValue(ui->stateValue->value());
     sig->setCode(ui->stateCode->toPlainText());
 
     mStateModel->update(row);
+
+    stateTransitionsUpdate(sig->code());
+
+    recordChange(new StateCommand(this, mStateModel,
+        ProjectCommand::Action_Edit, row, before, *sig, tr("Edit State"),
+        QString("state:%1").arg(row)));
+}
+
+void MainWindow::stateTransitionsUpdate(const QString& code)
+{
+    QStringList targets;
+
+    foreach(const TransitionGraph::Transition& trans,
+        TransitionGraph::parse(code))
+    {
+        QString target = trans.target;
+
+        if(!mStateModel->contains(target))
+            target = tr("%1 (unknown state)").arg(target);
+        else if(!trans.condition.isEmpty())
+            target = tr("%1 if %2").arg(target).arg(trans.condition);
+
+        targets.append(target);
+    }
+
+    if(targets.isEmpty())
+        ui->stateTransitions->setText(tr("Next states: none"));
+    else
+        ui->stateTransitions->setText(tr("Next states: %1").arg(targets.join("; ")));
 }
 
 void MainWindow::About()
@@ -1341,9 +1438,13 @@ void MainWindow::About()
 
 void MainWindow::Generate()
 {
+    // Only one generate at a time. The button is disabled meanwhile.
+    if(mGenerateWatcher->isRunning())
+        return;
+
     // Check if the file needs to be saved first.
     // Check for saving.
-    if(mCleanXml != SaveXml() || mProjectPath.isEmpty())
+    if(!mUndoStack->isClean() || mProjectPath.isEmpty())
     {
         int button = QMessageBox::question(this, tr("Save Project?"),
             tr("The project has unsaved changes. You must save it first. Save?"),
@@ -1354,317 +1455,125 @@ void MainWindow::Generate()
         if(mProjectPath.isEmpty())
         {
             QString path = QFileDialog::getSaveFileName(this, tr("Save Project"),
-                QString(), tr("State of Flux FSM (*.fsm)"));
+                QString(), tr("State of Flux FSM (*.fsm);;State of Flux Binary FSM (*.fsmb)"));
             if(path.isEmpty())
                 return;
 
             mProjectPath = path;
         }
 
-        QFile project(mProjectPath);
-        if(!project.open(QIODevice::WriteOnly) || !project.write(SaveXml().toUtf8()))
+        if(!project().save(mProjectPath))
         {
             QMessageBox::critical(this, tr("Save Failed"), tr("Failed to save the project."));
             return;
         }
 
-        mCleanXml = SaveXml();
-
-        project.close();
+        mUndoStack->setClean();
     }
 
-    QString code;
-    QString ext;
+    // The worker gets its own copy of the project so editing can go on.
+    Project snapshot = project();
 
-    switch(ui->outputLang->currentIndex())
-    {
-    case 1:
-        code = GenerateVHDL();
+    QString ext = "v";
+
+    if(snapshot.language() == Project::Language_VHDL)
         ext = "vhd";
-        break;
-    default:
-        code = GenerateVerilog();
-        ext = "v";
-        break;
-    }
+    else if(snapshot.language() == Project::Language_SystemVerilog)
+        ext = "sv";
 
     QString path = QString("%1/%2.%3").arg(
         QFileInfo(mProjectPath).absolutePath()).arg(
         QFileInfo(mProjectPath).baseName()).arg(ext);
 
-    if(QFileInfo(path).exists())
-    {
-        int button = QMessageBox::question(this, tr("Overwrite Generated Module"),
-            tr("The generated module already exists. Overwrite?"),
-            QMessageBox::Yes, QMessageBox::No);
-        if(button == QMessageBox::No)
-            return;
-    }
+    mGenerateCancel = QSharedPointer<QAtomicInt>(new QAtomicInt(0));
+    setGenerating(true);
 
-    // Save the generated file.
-    QFile genFile(path);
-    if(!genFile.open(QIODevice::WriteOnly) || !genFile.write(code.toUtf8()))
-    {
-        QMessageBox::critical(this, tr("Generate Failed"), tr("Failed to save the generated module."));
-    }
-
-    genFile.close();
+    mGenerateWatcher->setFuture(QtConcurrent::run(generateModule, snapshot,
+        path, mGenerateCancel));
 }
 
-QString MainWindow::GenerateVerilog() const
+void MainWindow::generateFinished()
 {
-    QString module = QFileInfo(mProjectPath).baseName();
-
-    QString src;
+    GenerateResult result = mGenerateWatcher->result();
 
-    QString header = trimBlankLines(ui->headerCode->toPlainText());
-    if(!header.isEmpty())
+    if(result.cancelled || result.unchanged)
     {
-        src += header;
-        src += "\n";
-    }
-
-    src += "`timescale 1ns / 1ps\n";
-
-    if(ui->defaultNettype->isChecked())
-        src += "`default_nettype none\n";
-
-    src += "\n";
-    src += QString("module %1(\n").arg(module);
-
-    QStringList io;
-
-    for(int i = 0; i < mIOSignalModel->rowCount(); i++)
-        io.append(indentLine(mIOSignalModel->at(i)->declaration()));
-
-    src += io.join(",\n");
-    src += "\n";
-    src += QString("%1);\n").arg(indent());
-
-    int stateCount = mStateModel->rowCount();
-    int stateBits = ceil(log2(stateCount));
-    if(stateCount <= 1)
-        stateBits = 1;
-
-    src += "\n";
-    src += indent() + "// States\n";
-
-    QStringList states;
-
-    for(int i = 0; i < mStateModel->rowCount(); i++)
-        states.append(indentLine(mStateModel->at(i)->declaration(stateBits, i)));
-
-    src += states.join("\n");
-    src += "\n\n";
-    src += indent() + "// Control Signals\n";
-
-    QStringList controlSignals;
-
-    for(int i = 0; i < mControlSignalModel->rowCount(); i++)
-        controlSignals.append(indentLine(mControlSignalModel->at(i)->declaration()));
-
-    src += controlSignals.join("\n");
-    src += "\n\n";
-    src += indent() + QString("reg [%1:0] current_state;\n").arg(stateBits - 1);
-    src += indent() + QString("reg [%1:0] next_state;\n").arg(stateBits - 1);
-
-    src += "\n";
-    if(ui->resetType->currentText().toLower() == "async")
-    {
-        src += indent() + QString("always @ (posedge %1, posedge %2)\n").arg(
-            ui->clockSignal->currentText()).arg(ui->resetSignal->currentText());
-    }
-    else
-    {
-        src += indent() + QString("always @ (posedge %1)\n").arg(
-            ui->clockSignal->currentText());
+        setGenerating(false);
+        return;
     }
 
-    src += indent() + "begin\n";
-    src += indent(2) + QString("if(%1) begin\n").arg(
-        ui->resetSignal->currentText());
-    src += indent(3) + QString("current_state <= %1;\n").arg(ui->stateReset->currentText());
-    src += indent(2) + "end else begin\n";
-    src += indent(3) + "current_state <= next_state;\n";
-    src += indent(2) + "end\n";
-    src += indent() + "end\n";
-    src += "\n";
-
-    if(ui->asciiStates->isChecked())
+    if(result.written)
     {
-        int maxStateLen = 0;
-
-        for(int i = 0; i < mStateModel->rowCount(); i++)
-        {
-            int stateLen = mStateModel->at(i)->name().length();
-            if(stateLen > maxStateLen)
-                maxStateLen = stateLen;
-        }
-
-        src += indent() + "// synopsys translate_off\n";
-        src += indent() + QString("reg [%1:0] ascii_current_state;\n").arg(maxStateLen * 8 - 1);
-        src += indent() + QString("reg [%1:0] ascii_next_state;\n").arg(maxStateLen * 8 - 1);
-        src += "\n";
-        src += indent() + "always @(current_state)\n";
-        src += indent() + "begin\n";
-        src += indent(2) + "case(current_state)\n";
+        setGenerating(false);
 
-        for(int i = 0; i < mStateModel->rowCount(); i++)
+        if(result.failed)
         {
-            QString state = mStateModel->at(i)->name();
-            src += indent(3) + QString("%1 ascii_current_state = \"%2\";\n").arg(
-                padLine(state + ":", maxStateLen + 1)).arg(padLine(state, maxStateLen));
+            QMessageBox::critical(this, tr("Generate Failed"),
+                tr("Failed to save the generated module."));
         }
 
-        src += indent(2) + "endcase\n";
-        src += indent() + "end\n";
-        src == "\n";
-        src += indent() + "always @(next_state)\n";
-        src += indent() + "begin\n";
-        src += indent(2) + "case(next_state)\n";
-
-        for(int i = 0; i < mStateModel->rowCount(); i++)
-        {
-            QString state = mStateModel->at(i)->name();
-            src += indent(3) + QString("%1 ascii_next_state = \"%2\";\n").arg(
-                padLine(state + ":", maxStateLen + 1)).arg(padLine(state, maxStateLen));
-        }
-
-        src += indent(2) + "endcase\n";
-        src += indent() + "end\n";
-
-        src += indent() + "// synopsys translate_on\n";
-    }
-
-    QString datapath = trimBlankLines(ui->dataCode->toPlainText());
-
-    if(!datapath.isEmpty())
-    {
-        src += "\n";
-        src += indentLines(datapath) + "\n";
-    }
-
-    QString tasks = trimBlankLines(ui->taskCode->toPlainText());
-
-    if(!tasks.isEmpty())
-    {
-        src += "\n";
-        src += indentLines(tasks) + "\n";
-    }
-
-    src += "\n";
-    src += indent() + "always @ (*)\n";
-    src += indent() + "begin\n";
-    src += indent(2) + "// Default values\n";
-    src += indent(2) + "next_state = current_state;\n";
-
-    QString stateDefaults = trimBlankLines(ui->stateDefaultsCode->toPlainText());
-
-    if(!stateDefaults.isEmpty())
-    {
-        src += indentLines(stateDefaults, 2) + "\n";
-    }
-
-    for(int i = 0; i < mControlSignalModel->rowCount(); i++)
-        src += indent(2) + QString("%1 = 0;\n").arg(mControlSignalModel->at(i)->name());
-
-    src += "\n";
-    src += indent(2) + "case(current_state)\n";
-
-    for(int i = 0; i < mStateModel->rowCount(); i++)
-    {
-        State *s = mStateModel->at(i);
-        src += indent(3) + QString("%1: begin\n").arg(s->name());
-
-        QString code = trimBlankLines(s->code());
-
-        src += indentLines(code, 4) + "\n";
-        src += indent(3) + QString("end // %1\n").arg(s->name());
+        return;
     }
 
-    src += indent(2) + "endcase\n";
-    src += indent() + "end\n";
-
-    src += "endmodule\n";
-
-    if(ui->defaultNettype->isChecked())
-        src += "\n`default_nettype wire\n";
-
-    // std::cout << src.toUtf8().constData() << std::endl;
-
-    return src;
-}
-
-QString MainWindow::GenerateVHDL() const
-{
-    /// @todo Implement VHDL
-    return QString();
-}
-
-QString MainWindow::indent(int level) const
-{
-    QString str;
-    int c = ui->indentValue->value();
-
-    if(ui->indentType->currentIndex() == 0) // Spaces
+    if(QFileInfo(result.path).exists())
     {
-        for(int i = 0; i < level; i++)
-        {
-            for(int j = 0; j < c; j++)
-                str += " ";
-        }
-    }
-    else // Tabs
-    {
-        for(int i = 0; i < level; i++)
+        int button = QMessageBox::question(this, tr("Overwrite Generated Module"),
+            tr("The generated module already exists. Overwrite?"),
+            QMessageBox::Yes, QMessageBox::No);
+        if(button == QMessageBox::No)
         {
-            for(int j = 0; j < c; j++)
-                str += "\t";
+            setGenerating(false);
+            return;
         }
     }
 
-    return str;
-}
+    // Save the generated file. There is nothing left to cancel.
+    mGenerateCancelButton->setEnabled(false);
+    ui->statusBar->showMessage(tr("Saving the generated module..."));
 
-QString MainWindow::indentLine(const QString& line, int level) const
-{
-    return QString("%1%2").arg(indent(level)).arg(line);
+    mGenerateWatcher->setFuture(QtConcurrent::run(writeModule, result));
 }
 
-QString MainWindow::indentLines(const QString& src, int level) const
+void MainWindow::generateCancel()
 {
-    QStringList lines = src.split("\n");
-    if(lines.isEmpty())
-        return QString();
+    if(mGenerateCancel)
+        mGenerateCancel->storeRelease(1);
 
-    QStringList newLines;
+    mGenerateCancelButton->setEnabled(false);
+}
 
-    foreach(QString line, lines)
-        newLines.append(indentLine(line, level));
+void MainWindow::setGenerating(bool generating)
+{
+    ui->generate->setEnabled(!generating);
+    mGenerateCancelButton->setEnabled(generating);
+    ui->statusBar->setVisible(generating);
 
-    return newLines.join("\n");
+    if(generating)
+        ui->statusBar->showMessage(tr("Generating the module..."));
+    else
+        ui->statusBar->clearMessage();
 }
 
-QString MainWindow::padLine(const QString& line, int length) const
+QByteArray MainWindow::GenerateVerilog(const Project& proj,
+    const QAtomicInt *cancel)
 {
-    QString str = line;
-
-    length -= str.length();
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
 
-    while(length-- > 0)
-        str += " ";
+    VerilogGenerator generator(proj);
+    generator.setCancelFlag(cancel);
+    generator.generate(&buffer);
 
-    return str;
+    return data;
 }
 
-QString MainWindow::trimBlankLines(const QString& line) const
+QByteArray MainWindow::GenerateVHDL(const Project& proj,
+    const QAtomicInt *cancel)
 {
-    if(line.isEmpty())
-        return QString();
+    Q_UNUSED(proj);
+    Q_UNUSED(cancel);
 
-    QString str = line;
-    while(str.at(str.length() - 1).isSpace())
-        str.truncate(str.length() - 1);
-
-    return str;
+    /// @todo Implement VHDL
+    return QByteArray();
 }
@@ -22,15 +22,47 @@
 
 #include <QMainWindow>
 
+#include <QtCore/QAtomicInt>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QHash>
+#include <QtCore/QSharedPointer>
+
 #include "IOSignalModel.h"
 #include "IOSignalModelInputs.h"
 #include "ControlSignalModel.h"
 #include "StateModel.h"
+#include "Project.h"
 
 namespace Ui {
 class MainWindow;
 }
 
+class ProjectCommand;
+class QPlainTextEdit;
+class QProgressBar;
+class QPushButton;
+class QUndoStack;
+class SymbolTable;
+
+/// What a background generate hands back to the GUI thread.
+typedef struct _GenerateResult
+{
+    QString path;
+    QByteArray data;
+
+    /// GenerationCache key of the project the module came from.
+    QByteArray key;
+
+    bool cancelled;
+
+    /// The file already holds exactly the generated module.
+    bool unchanged;
+
+    /// Set by the write step, which only runs after any overwrite prompt.
+    bool written;
+    bool failed;
+}GenerateResult;
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -39,21 +71,36 @@ public:
     explicit MainWindow(QWidget *parent = 0);
     ~MainWindow();
 
-    static bool validIdentifier(const QString& ident);
-
     bool signalExists(const QString& sigName) const;
 
+    Project project() const;
+    void setProject(const Project& proj);
+
+    /// The options alone, without the lists or the code.
+    Project options() const;
+    void setOptions(const Project& proj);
+
+    /// Show one of the code sections, named by its editor.
+    void setCode(const QString& editor, const QString& code);
+
+    /// Undo and redo change the project between these without recording.
+    void beginRestore();
+    void endRestore();
+
     QString SaveXml();
     void LoadXml(const QString& xml);
 
-    QString GenerateVerilog() const;
-    QString GenerateVHDL() const;
+    /// Show a newly opened project and start a fresh undo history.
+    void loadProject(const Project& proj);
 
-    QString indent(int level = 1) const;
-    QString indentLine(const QString& line, int level = 1) const;
-    QString indentLines(const QString& src, int level = 1) const;
-    QString padLine(const QString& line, int length = 1) const;
-    QString trimBlankLines(const QString& line) const;
+    /**
+     * These only read the snapshot so they are safe on a worker thread.
+     * GenerateVerilog() covers SystemVerilog too, going by the language.
+     */
+    static QByteArray GenerateVerilog(const Project& proj,
+        const QAtomicInt *cancel = 0);
+    static QByteArray GenerateVHDL(const Project& proj,
+        const QAtomicInt *cancel = 0);
 
 protected slots:
     void SaveTemplate();
@@ -76,6 +123,7 @@ protected slots:
     void controlListDelete();
     void controlListRename();
     void controlListChanged();
+    void controlListUpdate();
 
     void stateListAdd();
     void stateListUp();
@@ -86,11 +134,36 @@ protected slots:
 
     void instUpdate();
 
+    void optionsChanged();
+    void codeChanged();
+
+    void generateFinished();
+    void generateCancel();
+
 protected:
     void closeEvent(QCloseEvent *evt);
 
+    void stateTransitionsUpdate(const QString& code);
+
+    /**
+     * Push the change just made in the widgets onto the undo stack, taking
+     * ownership. Changes with the same key in a row are merged into one
+     * undo step.
+     */
+    void recordChange(ProjectCommand *cmd);
+
+    /// Show or hide the progress of a background generate.
+    void setGenerating(bool generating);
+
 private:
-    QString mCleanXml;
+    QUndoStack *mUndoStack;
+    bool mRecordChanges;
+
+    /// What the undo stack last saw, for the before side of the next edit.
+    Project mCurrentOptions;
+    QHash<QString, QString> mCurrentCode;
+    QList<QPlainTextEdit*> mCodeEdits;
+
     QString mDefaultTemplate;
     QString mProjectPath;
 
@@ -98,6 +171,12 @@ private:
     IOSignalModelInputs *mIOSignalModelShort;
     ControlSignalModel *mControlSignalModel;
     StateModel *mStateModel;
+    SymbolTable *mSymbolTable;
+
+    QFutureWatcher<GenerateResult> *mGenerateWatcher;
+    QSharedPointer<QAtomicInt> mGenerateCancel;
+    QProgressBar *mGenerateProgress;
+    QPushButton *mGenerateCancelButton;
 
     Ui::MainWindow *ui;
 };
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MappedFile.h"
+
+MappedFile::MappedFile(const QString& path) : mFile(path), mData(0), mSize(0)
+{
+    if(!mFile.open(QIODevice::ReadOnly))
+        return;
+
+    mSize = mFile.size();
+
+    // An empty file can not be mapped and is never a valid project anyway.
+    if(mSize > 0)
+        mData = mFile.map(0, mSize);
+
+    if(!mData)
+        mSize = 0;
+}
+
+MappedFile::~MappedFile()
+{
+    if(mData)
+        mFile.unmap(mData);
+}
+
+bool MappedFile::isValid() const
+{
+    return mData != 0;
+}
+
+const uchar* MappedFile::data() const
+{
+    return mData;
+}
+
+qint64 MappedFile::size() const
+{
+    return mSize;
+}
+
+QString MappedFile::text(quint32 offset, quint32 length) const
+{
+    if(!mData || (qint64)offset + length > mSize)
+        return QString();
+
+    return QString::fromUtf8(reinterpret_cast<const char*>(mData + offset),
+        (int)length);
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <QtCore/QFile>
+#include <QtCore/QString>
+
+/**
+ * Read only memory map of a whole file. States loaded from a binary project
+ * share one of these and decode their code from it on demand, so the map
+ * stays alive for as long as any copy of such a state does.
+ */
+class MappedFile
+{
+public:
+    explicit MappedFile(const QString& path);
+    ~MappedFile();
+
+    bool isValid() const;
+
+    const uchar* data() const;
+    qint64 size() const;
+
+    /// Decode a UTF-8 range of the file. Safe to call from any thread.
+    QString text(quint32 offset, quint32 length) const;
+
+private:
+    Q_DISABLE_COPY(MappedFile)
+
+    QFile mFile;
+    uchar *mData;
+    qint64 mSize;
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PassManager.h"
+#include "FsmModule.h"
+#include "FsmPass.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QStringList>
+
+PassManager::PassManager()
+{
+    // Nothing to see here.
+}
+
+PassManager::~PassManager()
+{
+    qDeleteAll(mPasses);
+}
+
+void PassManager::addPass(FsmPass *pass)
+{
+    mPasses.append(pass);
+}
+
+void PassManager::addStandardPasses()
+{
+    // Reduce first so the encoding is chosen for the states that are left.
+    addPass(new ReducePass);
+    addPass(new EncodingPass);
+    addPass(new OutputPass);
+}
+
+void PassManager::run(FsmModule& module)
+{
+    mTimings.clear();
+
+    QElapsedTimer timer;
+
+    foreach(FsmPass *pass, mPasses)
+    {
+        timer.start();
+        pass->run(module);
+
+        Timing timing;
+        timing.stage = pass->name();
+        timing.nsecs = timer.nsecsElapsed();
+        mTimings.append(timing);
+    }
+}
+
+QList<PassManager::Timing> PassManager::timings() const
+{
+    return mTimings;
+}
+
+QString PassManager::report(const QList<Timing>& timings)
+{
+    QStringList lines;
+
+    foreach(const Timing& timing, timings)
+    {
+        lines.append(QString("%1: %2 ms").arg(timing.stage).arg(
+            timing.nsecs / 1000000.0, 0, 'f', 3));
+    }
+
+    return lines.join("\n");
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PASSMANAGER_H
+#define PASSMANAGER_H
+
+#include <QtCore/QList>
+#include <QtCore/QString>
+
+class FsmModule;
+class FsmPass;
+
+/// Runs passes over a module in order and times each one.
+class PassManager
+{
+public:
+    typedef struct _Timing
+    {
+        QString stage;
+        qint64 nsecs;
+    }Timing;
+
+    PassManager();
+    ~PassManager();
+
+    /// Append a pass. The manager deletes it.
+    void addPass(FsmPass *pass);
+
+    /// The passes every backend relies on.
+    void addStandardPasses();
+
+    void run(FsmModule& module);
+
+    /// Time taken by each pass of the last run, in order.
+    QList<Timing> timings() const;
+
+    /// The timings as one line per stage.
+    static QString report(const QList<Timing>& timings);
+
+private:
+    Q_DISABLE_COPY(PassManager)
+
+    QList<FsmPass*> mPasses;
+    QList<Timing> mTimings;
+};
+
+#endif // PASSMANAGER_H
@@ -0,0 +1,707 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Project.h"
+#include "ProjectBinary.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QSet>
+#include <QtCore/QXmlStreamReader>
+#include <QtCore/QXmlStreamWriter>
+
+Project::Project() : mResetType(ResetType_Async), mAsciiStates(true),
+    mDefaultNettype(true), mRemoveUnreachable(false),
+    mMergeEquivalent(false), mLanguage(Language_Verilog),
+    mEncoding(Encoding_Binary), mTarget(Target_FPGA),
+    mIndentType(IndentType_Spaces), mIndentSize(2)
+{
+    // Nothing to see here.
+}
+
+QString Project::name() const
+{
+    return mName;
+}
+
+void Project::setName(const QString& _name)
+{
+    mName = _name;
+}
+
+QList<IOSignal> Project::ioSignals() const
+{
+    return mIOSignals;
+}
+
+void Project::setIOSignals(const QList<IOSignal>& sigs)
+{
+    mIOSignals = sigs;
+}
+
+QList<ControlSignal> Project::controlSignals() const
+{
+    return mControlSignals;
+}
+
+void Project::setControlSignals(const QList<ControlSignal>& sigs)
+{
+    mControlSignals = sigs;
+}
+
+QList<State> Project::states() const
+{
+    return mStates;
+}
+
+void Project::setStates(const QList<State>& _states)
+{
+    mStates = _states;
+}
+
+QString Project::clockSignal() const
+{
+    return mClockSignal;
+}
+
+void Project::setClockSignal(const QString& sigName)
+{
+    mClockSignal = sigName;
+}
+
+QString Project::resetSignal() const
+{
+    return mResetSignal;
+}
+
+void Project::setResetSignal(const QString& sigName)
+{
+    mResetSignal = sigName;
+}
+
+Project::ResetType Project::resetType() const
+{
+    return mResetType;
+}
+
+void Project::setResetType(ResetType type)
+{
+    mResetType = type;
+}
+
+QString Project::resetState() const
+{
+    return mResetState;
+}
+
+void Project::setResetState(const QString& state)
+{
+    mResetState = state;
+}
+
+bool Project::asciiStates() const
+{
+    return mAsciiStates;
+}
+
+void Project::setAsciiStates(bool enabled)
+{
+    mAsciiStates = enabled;
+}
+
+bool Project::defaultNettype() const
+{
+    return mDefaultNettype;
+}
+
+void Project::setDefaultNettype(bool enabled)
+{
+    mDefaultNettype = enabled;
+}
+
+bool Project::removeUnreachable() const
+{
+    return mRemoveUnreachable;
+}
+
+void Project::setRemoveUnreachable(bool enabled)
+{
+    mRemoveUnreachable = enabled;
+}
+
+bool Project::mergeEquivalent() const
+{
+    return mMergeEquivalent;
+}
+
+void Project::setMergeEquivalent(bool enabled)
+{
+    mMergeEquivalent = enabled;
+}
+
+Project::Language Project::language() const
+{
+    return mLanguage;
+}
+
+void Project::setLanguage(Language lang)
+{
+    mLanguage = lang;
+}
+
+Project::Encoding Project::encoding() const
+{
+    return mEncoding;
+}
+
+void Project::setEncoding(Encoding _encoding)
+{
+    mEncoding = _encoding;
+}
+
+Project::Target Project::target() const
+{
+    return mTarget;
+}
+
+void Project::setTarget(Target _target)
+{
+    mTarget = _target;
+}
+
+Project::IndentType Project::indentType() const
+{
+    return mIndentType;
+}
+
+void Project::setIndentType(IndentType type)
+{
+    mIndentType = type;
+}
+
+int Project::indentSize() const
+{
+    return mIndentSize;
+}
+
+void Project::setIndentSize(int size)
+{
+    mIndentSize = size;
+}
+
+QString Project::datapathCode() const
+{
+    return mDatapathCode;
+}
+
+void Project::setDatapathCode(const QString& code)
+{
+    mDatapathCode = code;
+}
+
+QString Project::headerCode() const
+{
+    return mHeaderCode;
+}
+
+void Project::setHeaderCode(const QString& code)
+{
+    mHeaderCode = code;
+}
+
+QString Project::taskCode() const
+{
+    return mTaskCode;
+}
+
+void Project::setTaskCode(const QString& code)
+{
+    mTaskCode = code;
+}
+
+QString Project::stateDefaultsCode() const
+{
+    return mStateDefaultsCode;
+}
+
+void Project::setStateDefaultsCode(const QString& code)
+{
+    mStateDefaultsCode = code;
+}
+
+QStringList Project::clockResetCandidates() const
+{
+    QStringList candidates;
+
+    // Same filter as IOSignalModelInputs.
+    foreach(const IOSignal& sig, mIOSignals)
+    {
+        if(sig.direction() == IOSignal::Direction_Input && (
+            sig.type() == IOSignal::Type_Wire ||
+            sig.type() == IOSignal::Type_Logic) &&
+            sig.size() == 1)
+        {
+            candidates.append(sig.name());
+        }
+    }
+
+    return candidates;
+}
+
+static void addHashField(QCryptographicHash& hash, const QString& field)
+{
+    QByteArray data = field.toUtf8();
+
+    // Prefix the length so adjacent fields can't run into each other.
+    hash.addData(QByteArray::number(data.size()) + ":");
+    hash.addData(data);
+}
+
+static void addHashField(QCryptographicHash& hash, int field)
+{
+    addHashField(hash, QString::number(field));
+}
+
+QByteArray Project::hash() const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    addHashField(hash, mName);
+
+    addHashField(hash, mIOSignals.count());
+    foreach(const IOSignal& sig, mIOSignals)
+    {
+        addHashField(hash, sig.name());
+        addHashField(hash, sig.direction());
+        addHashField(hash, sig.type());
+        addHashField(hash, sig.size());
+    }
+
+    addHashField(hash, mControlSignals.count());
+    foreach(const ControlSignal& sig, mControlSignals)
+    {
+        addHashField(hash, sig.name());
+        addHashField(hash, sig.registered());
+    }
+
+    addHashField(hash, mStates.count());
+    foreach(const State& state, mStates)
+    {
+        addHashField(hash, state.name());
+        addHashField(hash, state.value());
+        addHashField(hash, state.code());
+    }
+
+    addHashField(hash, mClockSignal);
+    addHashField(hash, mResetSignal);
+    addHashField(hash, mResetType);
+    addHashField(hash, mResetState);
+
+    addHashField(hash, mAsciiStates);
+    addHashField(hash, mDefaultNettype);
+    addHashField(hash, mRemoveUnreachable);
+    addHashField(hash, mMergeEquivalent);
+    addHashField(hash, mLanguage);
+    addHashField(hash, mEncoding);
+    addHashField(hash, mTarget);
+    addHashField(hash, mIndentType);
+    addHashField(hash, mIndentSize);
+
+    addHashField(hash, mDatapathCode);
+    addHashField(hash, mHeaderCode);
+    addHashField(hash, mTaskCode);
+    addHashField(hash, mStateDefaultsCode);
+
+    return hash.result();
+}
+
+QString Project::toXml() const
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    write(&buffer);
+
+    return QString::fromUtf8(buffer.data());
+}
+
+bool Project::write(QIODevice *device) const
+{
+    QXmlStreamWriter xml(device);
+    xml.setAutoFormatting(true);
+    xml.setAutoFormattingIndent(1);
+
+    xml.writeStartDocument();
+    xml.writeStartElement("state_of_flux");
+
+    foreach(const IOSignal& sig, mIOSignals)
+        sig.write(xml);
+
+    foreach(const ControlSignal& sig, mControlSignals)
+        sig.write(xml);
+
+    foreach(const State& state, mStates)
+        state.write(xml);
+
+    xml.writeStartElement("clock");
+    xml.writeAttribute("signal", mClockSignal);
+    xml.writeEndElement();
+
+    xml.writeStartElement("reset");
+    xml.writeAttribute("signal", mResetSignal);
+
+    switch(mResetType)
+    {
+    case ResetType_Async:
+        xml.writeAttribute("type", "async");
+        break;
+    default:
+        xml.writeAttribute("type", "sync");
+        break;
+    }
+
+    xml.writeEndElement();
+
+    xml.writeStartElement("options");
+    xml.writeAttribute("ascii_states", QString::number(mAsciiStates));
+    xml.writeAttribute("default_nettype", QString::number(mDefaultNettype));
+    xml.writeAttribute("remove_unreachable", QString::number(mRemoveUnreachable));
+    xml.writeAttribute("merge_equivalent", QString::number(mMergeEquivalent));
+    if(mLanguage == Language_VHDL)
+        xml.writeAttribute("language", "vhdl");
+    else if(mLanguage == Language_SystemVerilog)
+        xml.writeAttribute("language", "systemverilog");
+    else
+        xml.writeAttribute("language", "verilog");
+
+    switch(mEncoding)
+    {
+    case Encoding_OneHot:
+        xml.writeAttribute("encoding", "one_hot");
+        break;
+    case Encoding_Gray:
+        xml.writeAttribute("encoding", "gray");
+        break;
+    case Encoding_Johnson:
+        xml.writeAttribute("encoding", "johnson");
+        break;
+    case Encoding_Auto:
+        xml.writeAttribute("encoding", "auto");
+        break;
+    default:
+        xml.writeAttribute("encoding", "binary");
+        break;
+    }
+
+    xml.writeAttribute("target", mTarget == Target_ASIC ? "asic" : "fpga");
+
+    xml.writeAttribute("indent_type",
+        mIndentType == IndentType_Tabs ? "tabs" : "spaces");
+    xml.writeAttribute("indent_size", QString::number(mIndentSize));
+    xml.writeEndElement();
+
+    xml.writeStartElement("datapath");
+    xml.writeCDATA(mDatapathCode);
+    xml.writeEndElement();
+
+    xml.writeStartElement("header");
+    xml.writeCDATA(mHeaderCode);
+    xml.writeEndElement();
+
+    xml.writeStartElement("tasks");
+    xml.writeCDATA(mTaskCode);
+    xml.writeEndElement();
+
+    xml.writeStartElement("state_defaults");
+    xml.writeCDATA(mStateDefaultsCode);
+    xml.writeEndElement();
+
+    xml.writeStartElement("reset_state");
+    xml.writeAttribute("state", mResetState);
+    xml.writeEndElement();
+
+    xml.writeEndElement();
+    xml.writeEndDocument();
+
+    return !xml.hasError();
+}
+
+bool Project::save(const QString& path) const
+{
+    // Write next to the project and rename over it once complete so a
+    // failed save never leaves a truncated project behind.
+    QSaveFile file(path);
+
+    bool written = file.open(QIODevice::WriteOnly);
+
+    if(written)
+    {
+        if(ProjectBinary::isBinaryPath(path))
+            written = ProjectBinary::write(*this, &file);
+        else
+            written = write(&file);
+    }
+
+    if(!written)
+    {
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
+
+bool Project::fromXml(const QString& xml)
+{
+    QXmlStreamReader reader(xml);
+
+    return read(reader);
+}
+
+bool Project::read(QIODevice *device)
+{
+    QXmlStreamReader reader(device);
+
+    return read(reader);
+}
+
+bool Project::read(QXmlStreamReader& xml)
+{
+    if(!xml.readNextStartElement() || xml.name() != "state_of_flux")
+        return false;
+
+    mIOSignals.clear();
+    mControlSignals.clear();
+    mStates.clear();
+
+    mClockSignal.clear();
+    mResetSignal.clear();
+    mResetType = ResetType_Async;
+    mResetState.clear();
+
+    mAsciiStates = true;
+    mDefaultNettype = true;
+    mRemoveUnreachable = false;
+    mMergeEquivalent = false;
+    mLanguage = Language_Verilog;
+    mEncoding = Encoding_Binary;
+    mTarget = Target_FPGA;
+    mIndentType = IndentType_Spaces;
+    mIndentSize = 2;
+
+    mDatapathCode.clear();
+    mHeaderCode.clear();
+    mTaskCode.clear();
+    mStateDefaultsCode.clear();
+
+    // Only the first of the single elements counts.
+    QSet<QString> seen;
+
+    // As in the models, only the first signal or state of a name counts.
+    QSet<QString> ioNames;
+    QSet<QString> controlNames;
+    QSet<QString> stateNames;
+
+    while(!xml.atEnd())
+    {
+        if(xml.readNext() != QXmlStreamReader::StartElement)
+            continue;
+
+        QString name = xml.name().toString();
+
+        if(name == "io_signal")
+        {
+            IOSignal *sig = IOSignal::fromXml(xml);
+
+            if(!ioNames.contains(sig->name()))
+            {
+                ioNames.insert(sig->name());
+                mIOSignals.append(*sig);
+            }
+
+            delete sig;
+            continue;
+        }
+
+        if(name == "control_signal")
+        {
+            ControlSignal *sig = ControlSignal::fromXml(xml);
+
+            if(!controlNames.contains(sig->name()))
+            {
+                controlNames.insert(sig->name());
+                mControlSignals.append(*sig);
+            }
+
+            delete sig;
+            continue;
+        }
+
+        if(name == "state")
+        {
+            State *state = State::fromXml(xml);
+
+            if(!stateNames.contains(state->name()))
+            {
+                stateNames.insert(state->name());
+                mStates.append(*state);
+            }
+
+            delete state;
+            continue;
+        }
+
+        if(seen.contains(name))
+            continue;
+
+        seen.insert(name);
+
+        QXmlStreamAttributes attrs = xml.attributes();
+
+        if(name == "clock")
+        {
+            mClockSignal = attrs.value("signal").toString();
+        }
+        else if(name == "reset")
+        {
+            mResetSignal = attrs.value("signal").toString();
+
+            if(attrs.value("type").toString().toLower().trimmed() == "sync")
+                mResetType = ResetType_Sync;
+            else
+                mResetType = ResetType_Async;
+        }
+        else if(name == "options")
+        {
+            mAsciiStates = attrs.value("ascii_states").toString().toInt();
+            mDefaultNettype = attrs.value("default_nettype").toString().toInt();
+            mRemoveUnreachable = attrs.value("remove_unreachable").toString().toInt();
+            mMergeEquivalent = attrs.value("merge_equivalent").toString().toInt();
+            QString language = attrs.value("language").toString().toLower().trimmed();
+
+            if(language == "vhdl")
+                mLanguage = Language_VHDL;
+            else if(language == "systemverilog")
+                mLanguage = Language_SystemVerilog;
+            else
+                mLanguage = Language_Verilog;
+
+            QString encoding = attrs.value("encoding").toString().toLower().trimmed();
+
+            if(encoding == "one_hot")
+                mEncoding = Encoding_OneHot;
+            else if(encoding == "gray")
+                mEncoding = Encoding_Gray;
+            else if(encoding == "johnson")
+                mEncoding = Encoding_Johnson;
+            else if(encoding == "auto")
+                mEncoding = Encoding_Auto;
+            else
+                mEncoding = Encoding_Binary;
+
+            mTarget = attrs.value("target").toString().toLower().trimmed() == "asic" ?
+                Target_ASIC : Target_FPGA;
+
+            mIndentType = attrs.value("indent_type").toString().toLower().trimmed() == "tabs" ?
+                IndentType_Tabs : IndentType_Spaces;
+            mIndentSize = qBound(0, attrs.value("indent_size").toString().toInt(), 99);
+        }
+        else if(name == "datapath")
+        {
+            mDatapathCode = xml.readElementText(
+                QXmlStreamReader::IncludeChildElements);
+        }
+        else if(name == "header")
+        {
+            mHeaderCode = xml.readElementText(
+                QXmlStreamReader::IncludeChildElements);
+        }
+        else if(name == "tasks")
+        {
+            mTaskCode = xml.readElementText(
+                QXmlStreamReader::IncludeChildElements);
+        }
+        else if(name == "state_defaults")
+        {
+            mStateDefaultsCode = xml.readElementText(
+                QXmlStreamReader::IncludeChildElements);
+        }
+        else if(name == "reset_state")
+        {
+            mResetState = attrs.value("state").toString();
+        }
+    }
+
+    if(xml.hasError())
+        return false;
+
+    resolveFallbacks();
+
+    return true;
+}
+
+void Project::resolveFallbacks()
+{
+    // The clock and reset combo boxes only offer single bit inputs and fall
+    // back to the first one when the saved name is not in the list.
+    QStringList candidates = clockResetCandidates();
+
+    if(!candidates.contains(mClockSignal))
+        mClockSignal = candidates.isEmpty() ? QString() : candidates.first();
+
+    if(!candidates.contains(mResetSignal))
+        mResetSignal = candidates.isEmpty() ? QString() : candidates.first();
+
+    bool resetStateFound = false;
+
+    foreach(const State& state, mStates)
+    {
+        if(state.name() == mResetState)
+        {
+            resetStateFound = true;
+            break;
+        }
+    }
+
+    if(!resetStateFound)
+        mResetState = mStates.isEmpty() ? QString() : mStates.first().name();
+}
+
+bool Project::load(const QString& path)
+{
+    if(ProjectBinary::isBinaryPath(path))
+    {
+        if(!ProjectBinary::read(path, *this))
+            return false;
+
+        resolveFallbacks();
+    }
+    else
+    {
+        QFile project(path);
+        if(!project.open(QIODevice::ReadOnly) || !read(&project))
+            return false;
+    }
+
+    mName = QFileInfo(path).baseName();
+
+    return true;
+}
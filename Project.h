@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROJECT_H
+#define PROJECT_H
+
+#include <QtCore/QIODevice>
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QXmlStreamReader>
+
+#include "IOSignal.h"
+#include "ControlSignal.h"
+#include "State.h"
+
+/**
+ * Everything needed to generate a module from a .fsm file. This holds the
+ * signals and states by value so a copy is a cheap, self contained snapshot
+ * that does not depend on any widget or model.
+ */
+class Project
+{
+public:
+    Project();
+
+    typedef enum _ResetType
+    {
+        ResetType_Async = 0,
+        ResetType_Sync
+    }ResetType;
+
+    typedef enum _Language
+    {
+        Language_Verilog = 0,
+        Language_VHDL,
+        Language_SystemVerilog
+    }Language;
+
+    typedef enum _Encoding
+    {
+        Encoding_Binary = 0,
+        Encoding_OneHot,
+        Encoding_Gray,
+        Encoding_Johnson,
+        Encoding_Auto
+    }Encoding;
+
+    typedef enum _Target
+    {
+        Target_FPGA = 0,
+        Target_ASIC
+    }Target;
+
+    typedef enum _IndentType
+    {
+        IndentType_Spaces = 0,
+        IndentType_Tabs
+    }IndentType;
+
+    /// Name of the generated module (the base name of the project file).
+    QString name() const;
+    void setName(const QString& name);
+
+    QList<IOSignal> ioSignals() const;
+    void setIOSignals(const QList<IOSignal>& sigs);
+
+    QList<ControlSignal> controlSignals() const;
+    void setControlSignals(const QList<ControlSignal>& sigs);
+
+    QList<State> states() const;
+    void setStates(const QList<State>& states);
+
+    QString clockSignal() const;
+    void setClockSignal(const QString& sigName);
+
+    QString resetSignal() const;
+    void setResetSignal(const QString& sigName);
+
+    ResetType resetType() const;
+    void setResetType(ResetType type);
+
+    QString resetState() const;
+    void setResetState(const QString& state);
+
+    bool asciiStates() const;
+    void setAsciiStates(bool enabled);
+
+    bool defaultNettype() const;
+    void setDefaultNettype(bool enabled);
+
+    /// Leave states that can not be reached from the reset state out.
+    bool removeUnreachable() const;
+    void setRemoveUnreachable(bool enabled);
+
+    /// Merge states that behave the same into one.
+    bool mergeEquivalent() const;
+    void setMergeEquivalent(bool enabled);
+
+    Language language() const;
+    void setLanguage(Language lang);
+
+    Encoding encoding() const;
+    void setEncoding(Encoding encoding);
+
+    /// Device family the automatic encoding is tuned for.
+    Target target() const;
+    void setTarget(Target target);
+
+    IndentType indentType() const;
+    void setIndentType(IndentType type);
+
+    int indentSize() const;
+    void setIndentSize(int size);
+
+    QString datapathCode() const;
+    void setDatapathCode(const QString& code);
+
+    QString headerCode() const;
+    void setHeaderCode(const QString& code);
+
+    QString taskCode() const;
+    void setTaskCode(const QString& code);
+
+    QString stateDefaultsCode() const;
+    void setStateDefaultsCode(const QString& code);
+
+    /// Signals that may be picked as the clock or reset.
+    QStringList clockResetCandidates() const;
+
+    /**
+     * Hash of everything that affects the generated module. Unlike toXml()
+     * this does not depend on attribute order so it is stable between runs.
+     */
+    QByteArray hash() const;
+
+    QString toXml() const;
+    bool fromXml(const QString& xml);
+
+    /// Stream the project to the device as it is written.
+    bool write(QIODevice *device) const;
+
+    /// Read a project in a single pass without building a document.
+    bool read(QIODevice *device);
+
+    /// Load or save XML or, for a .fsmb path, the binary format.
+    bool load(const QString& path);
+    bool save(const QString& path) const;
+
+private:
+    bool read(QXmlStreamReader& xml);
+
+    /// Fall back to the first candidate for a missing clock, reset or state.
+    void resolveFallbacks();
+
+    QString mName;
+
+    QList<IOSignal> mIOSignals;
+    QList<ControlSignal> mControlSignals;
+    QList<State> mStates;
+
+    QString mClockSignal;
+    QString mResetSignal;
+    ResetType mResetType;
+    QString mResetState;
+
+    bool mAsciiStates;
+    bool mDefaultNettype;
+    bool mRemoveUnreachable;
+    bool mMergeEquivalent;
+    Language mLanguage;
+    Encoding mEncoding;
+    Target mTarget;
+    IndentType mIndentType;
+    int mIndentSize;
+
+    QString mDatapathCode;
+    QString mHeaderCode;
+    QString mTaskCode;
+    QString mStateDefaultsCode;
+};
+
+#endif // PROJECT_H
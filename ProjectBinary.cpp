@@ -0,0 +1,406 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ProjectBinary.h"
+#include "MappedFile.h"
+#include "Project.h"
+
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QtEndian>
+
+#include <string.h>
+
+static const char FORMAT_MAGIC[4] = { 'F', 'S', 'M', 'B' };
+static const quint32 FORMAT_VERSION = 1;
+
+static const int HEADER_SIZE = 40;
+static const int PROJECT_RECORD_SIZE = 52;
+static const int IO_RECORD_SIZE = 12;
+static const int CONTROL_RECORD_SIZE = 8;
+static const int STATE_RECORD_SIZE = 16;
+static const int STRING_RECORD_SIZE = 8;
+
+static const quint8 FLAG_ASCII_STATES = 0x01;
+static const quint8 FLAG_DEFAULT_NETTYPE = 0x02;
+static const quint8 FLAG_REMOVE_UNREACHABLE = 0x04;
+static const quint8 FLAG_MERGE_EQUIVALENT = 0x08;
+
+static const quint32 CONTROL_REGISTERED = 0x01;
+
+static void putU8(QByteArray& buf, quint8 value)
+{
+    buf.append((char)value);
+}
+
+static void putU32(QByteArray& buf, quint32 value)
+{
+    uchar bytes[4];
+    qToLittleEndian<quint32>(value, bytes);
+
+    buf.append(reinterpret_cast<const char*>(bytes), 4);
+}
+
+static quint32 getU32(const uchar *data)
+{
+    return qFromLittleEndian<quint32>(data);
+}
+
+/// Identifiers are stored once no matter how many records use them.
+class StringTable
+{
+public:
+    StringTable() : mCount(0)
+    {
+        // Nothing to see here.
+    }
+
+    quint32 add(const QString& str)
+    {
+        QHash<QString, quint32>::const_iterator it = mIndex.constFind(str);
+        if(it != mIndex.constEnd())
+            return it.value();
+
+        QByteArray utf8 = str.toUtf8();
+
+        putU32(mRecords, (quint32)mData.size());
+        putU32(mRecords, (quint32)utf8.size());
+        mData.append(utf8);
+
+        mIndex.insert(str, mCount);
+
+        return mCount++;
+    }
+
+    quint32 count() const
+    {
+        return mCount;
+    }
+
+    const QByteArray& records() const
+    {
+        return mRecords;
+    }
+
+    const QByteArray& data() const
+    {
+        return mData;
+    }
+
+private:
+    QHash<QString, quint32> mIndex;
+    QByteArray mRecords;
+    QByteArray mData;
+    quint32 mCount;
+};
+
+/// Append the code to the blob and its offset and length to the record.
+static void putCode(QByteArray& record, QByteArray& blob, const QString& code)
+{
+    QByteArray utf8 = code.toUtf8();
+
+    putU32(record, (quint32)blob.size());
+    putU32(record, (quint32)utf8.size());
+    blob.append(utf8);
+}
+
+bool ProjectBinary::isBinaryPath(const QString& path)
+{
+    return QFileInfo(path).suffix().toLower() == "fsmb";
+}
+
+bool ProjectBinary::write(const Project& project, QIODevice *device)
+{
+    QList<IOSignal> ioSignals = project.ioSignals();
+    QList<ControlSignal> controlSignals = project.controlSignals();
+    QList<State> states = project.states();
+
+    StringTable strings;
+    QByteArray records;
+    QByteArray code;
+
+    records.reserve(PROJECT_RECORD_SIZE + ioSignals.count() * IO_RECORD_SIZE +
+        controlSignals.count() * CONTROL_RECORD_SIZE +
+        states.count() * STATE_RECORD_SIZE);
+
+    quint8 flags = 0;
+
+    if(project.asciiStates())
+        flags |= FLAG_ASCII_STATES;
+    if(project.defaultNettype())
+        flags |= FLAG_DEFAULT_NETTYPE;
+    if(project.removeUnreachable())
+        flags |= FLAG_REMOVE_UNREACHABLE;
+    if(project.mergeEquivalent())
+        flags |= FLAG_MERGE_EQUIVALENT;
+
+    putU32(records, strings.add(project.clockSignal()));
+    putU32(records, strings.add(project.resetSignal()));
+    putU32(records, strings.add(project.resetState()));
+    putU8(records, (quint8)project.resetType());
+    putU8(records, (quint8)project.language());
+    putU8(records, (quint8)project.encoding());
+    putU8(records, (quint8)project.target());
+    putU8(records, (quint8)project.indentType());
+    putU8(records, (quint8)project.indentSize());
+    putU8(records, flags);
+    putU8(records, 0);
+    putCode(records, code, project.datapathCode());
+    putCode(records, code, project.headerCode());
+    putCode(records, code, project.taskCode());
+    putCode(records, code, project.stateDefaultsCode());
+
+    foreach(const IOSignal& sig, ioSignals)
+    {
+        putU32(records, strings.add(sig.name()));
+        putU8(records, (quint8)sig.direction());
+        putU8(records, (quint8)sig.type());
+        putU8(records, 0);
+        putU8(records, 0);
+        putU32(records, (quint32)sig.size());
+    }
+
+    foreach(const ControlSignal& sig, controlSignals)
+    {
+        putU32(records, strings.add(sig.name()));
+        putU32(records, sig.registered() ? CONTROL_REGISTERED : 0);
+    }
+
+    foreach(const State& state, states)
+    {
+        putU32(records, strings.add(state.name()));
+        putU32(records, (quint32)(qint32)state.value());
+        putCode(records, code, state.code());
+    }
+
+    quint32 stringDataOffset = HEADER_SIZE + records.size() +
+        strings.records().size();
+    quint32 codeOffset = stringDataOffset + strings.data().size();
+
+    QByteArray header;
+    header.reserve(HEADER_SIZE);
+    header.append(FORMAT_MAGIC, 4);
+    putU32(header, FORMAT_VERSION);
+    putU32(header, (quint32)ioSignals.count());
+    putU32(header, (quint32)controlSignals.count());
+    putU32(header, (quint32)states.count());
+    putU32(header, strings.count());
+    putU32(header, stringDataOffset);
+    putU32(header, (quint32)strings.data().size());
+    putU32(header, codeOffset);
+    putU32(header, (quint32)code.size());
+
+    return device->write(header) == header.size() &&
+        device->write(records) == records.size() &&
+        device->write(strings.records()) == strings.records().size() &&
+        device->write(strings.data()) == strings.data().size() &&
+        device->write(code) == code.size();
+}
+
+bool ProjectBinary::read(const QString& path, Project& project)
+{
+    QSharedPointer<const MappedFile> file(new MappedFile(path));
+
+    if(!file->isValid() || file->size() < HEADER_SIZE)
+        return false;
+
+    const uchar *data = file->data();
+    qint64 size = file->size();
+
+    if(memcmp(data, FORMAT_MAGIC, 4) != 0 || getU32(data + 4) != FORMAT_VERSION)
+        return false;
+
+    quint32 ioCount = getU32(data + 8);
+    quint32 controlCount = getU32(data + 12);
+    quint32 stateCount = getU32(data + 16);
+    quint32 stringCount = getU32(data + 20);
+    quint32 stringDataOffset = getU32(data + 24);
+    quint32 stringDataSize = getU32(data + 28);
+    quint32 codeOffset = getU32(data + 32);
+    quint32 codeSize = getU32(data + 36);
+
+    // Check every section lies inside the file before touching any of it.
+    qint64 ioOffset = HEADER_SIZE + PROJECT_RECORD_SIZE;
+    qint64 controlOffset = ioOffset + (qint64)ioCount * IO_RECORD_SIZE;
+    qint64 stateOffset = controlOffset + (qint64)controlCount * CONTROL_RECORD_SIZE;
+    qint64 stringIndexOffset = stateOffset + (qint64)stateCount * STATE_RECORD_SIZE;
+    qint64 stringIndexEnd = stringIndexOffset + (qint64)stringCount * STRING_RECORD_SIZE;
+
+    if(stringIndexEnd > size || (qint64)stringDataOffset + stringDataSize > size ||
+        (qint64)codeOffset + codeSize > size)
+    {
+        return false;
+    }
+
+    QStringList strings;
+    strings.reserve(stringCount);
+
+    for(quint32 i = 0; i < stringCount; i++)
+    {
+        const uchar *rec = data + stringIndexOffset + i * STRING_RECORD_SIZE;
+        quint32 offset = getU32(rec);
+        quint32 length = getU32(rec + 4);
+
+        if((qint64)offset + length > stringDataSize)
+            return false;
+
+        strings.append(file->text(stringDataOffset + offset, length));
+    }
+
+    const uchar *rec = data + HEADER_SIZE;
+
+    quint32 clockIndex = getU32(rec);
+    quint32 resetIndex = getU32(rec + 4);
+    quint32 resetStateIndex = getU32(rec + 8);
+
+    if(clockIndex >= stringCount || resetIndex >= stringCount ||
+        resetStateIndex >= stringCount)
+    {
+        return false;
+    }
+
+    quint8 resetType = rec[12];
+    quint8 language = rec[13];
+    quint8 encoding = rec[14];
+    quint8 target = rec[15];
+    quint8 indentType = rec[16];
+    quint8 indentSize = rec[17];
+    quint8 flags = rec[18];
+
+    if(resetType > Project::ResetType_Sync || language > Project::Language_SystemVerilog ||
+        encoding > Project::Encoding_Auto || target > Project::Target_ASIC ||
+        indentType > Project::IndentType_Tabs)
+    {
+        return false;
+    }
+
+    // The shared code sections are small and always needed, so decode them
+    // now and only leave the state code in the map.
+    QString sharedCode[4];
+
+    for(int i = 0; i < 4; i++)
+    {
+        quint32 offset = getU32(rec + 20 + i * 8);
+        quint32 length = getU32(rec + 24 + i * 8);
+
+        if((qint64)offset + length > codeSize)
+            return false;
+
+        sharedCode[i] = file->text(codeOffset + offset, length);
+    }
+
+    QList<IOSignal> ioSignals;
+    ioSignals.reserve(ioCount);
+
+    for(quint32 i = 0; i < ioCount; i++)
+    {
+        rec = data + ioOffset + i * IO_RECORD_SIZE;
+
+        quint32 nameIndex = getU32(rec);
+        if(nameIndex >= stringCount || rec[4] > IOSignal::Direction_Inout ||
+            rec[5] > IOSignal::Type_Logic)
+        {
+            return false;
+        }
+
+        IOSignal sig;
+        sig.setName(strings.at(nameIndex));
+        if(!IOSignal::validIdentifier(sig.name()))
+            sig.setName("invalid_name");
+
+        sig.setDirection((IOSignal::Direction)rec[4]);
+        sig.setType((IOSignal::Type)rec[5]);
+        sig.setSize(qMax(1, (int)getU32(rec + 8)));
+
+        ioSignals.append(sig);
+    }
+
+    QList<ControlSignal> controlSignals;
+    controlSignals.reserve(controlCount);
+
+    for(quint32 i = 0; i < controlCount; i++)
+    {
+        rec = data + controlOffset + i * CONTROL_RECORD_SIZE;
+
+        quint32 nameIndex = getU32(rec);
+        if(nameIndex >= stringCount)
+            return false;
+
+        ControlSignal sig;
+        sig.setName(strings.at(nameIndex));
+        if(!ControlSignal::validIdentifier(sig.name()))
+            sig.setName("invalid_name");
+
+        sig.setRegistered(getU32(rec + 4) & CONTROL_REGISTERED);
+
+        controlSignals.append(sig);
+    }
+
+    QList<State> states;
+    states.reserve(stateCount);
+
+    for(quint32 i = 0; i < stateCount; i++)
+    {
+        rec = data + stateOffset + i * STATE_RECORD_SIZE;
+
+        quint32 nameIndex = getU32(rec);
+        quint32 offset = getU32(rec + 8);
+        quint32 length = getU32(rec + 12);
+
+        if(nameIndex >= stringCount || (qint64)offset + length > codeSize)
+            return false;
+
+        State state;
+        state.setName(strings.at(nameIndex));
+        if(!State::validIdentifier(state.name()))
+            state.setName("invalid_name");
+
+        state.setValue((qint32)getU32(rec + 4));
+        state.setCode(file, codeOffset + offset, length);
+
+        states.append(state);
+    }
+
+    project.setIOSignals(ioSignals);
+    project.setControlSignals(controlSignals);
+    project.setStates(states);
+
+    project.setClockSignal(strings.at(clockIndex));
+    project.setResetSignal(strings.at(resetIndex));
+    project.setResetType((Project::ResetType)resetType);
+    project.setResetState(strings.at(resetStateIndex));
+
+    project.setAsciiStates(flags & FLAG_ASCII_STATES);
+    project.setDefaultNettype(flags & FLAG_DEFAULT_NETTYPE);
+    project.setRemoveUnreachable(flags & FLAG_REMOVE_UNREACHABLE);
+    project.setMergeEquivalent(flags & FLAG_MERGE_EQUIVALENT);
+    project.setLanguage((Project::Language)language);
+    project.setEncoding((Project::Encoding)encoding);
+    project.setTarget((Project::Target)target);
+    project.setIndentType((Project::IndentType)indentType);
+    project.setIndentSize(qMin((int)indentSize, 99));
+
+    project.setDatapathCode(sharedCode[0]);
+    project.setHeaderCode(sharedCode[1]);
+    project.setTaskCode(sharedCode[2]);
+    project.setStateDefaultsCode(sharedCode[3]);
+
+    return true;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROJECTBINARY_H
+#define PROJECTBINARY_H
+
+#include <QtCore/QIODevice>
+#include <QtCore/QString>
+
+class Project;
+
+/**
+ * The binary .fsmb project format. It holds exactly what the XML format
+ * does, laid out so a large project can be memory mapped and its state
+ * code left undecoded until something asks for it.
+ *
+ * All integers are little endian:
+ *  - header: "FSMB", version and the counts, offsets and sizes below
+ *  - one project record with the options and the shared code ranges
+ *  - fixed size IO signal, control signal and state records
+ *  - the string index, an offset and length per identifier
+ *  - the UTF-8 identifier data
+ *  - the UTF-8 code blob the records point into
+ */
+class ProjectBinary
+{
+public:
+    /// Binary projects are told apart from XML ones by the .fsmb suffix.
+    static bool isBinaryPath(const QString& path);
+
+    static bool write(const Project& project, QIODevice *device);
+
+    /// Map the file and fill in the project. The state code stays mapped.
+    static bool read(const QString& path, Project& project);
+};
+
+#endif // PROJECTBINARY_H
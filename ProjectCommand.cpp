@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ProjectCommand.h"
+#include "MainWindow.h"
+
+ProjectCommand::ProjectCommand(MainWindow *window, const QString& text,
+    const QString& key) : QUndoCommand(text), mWindow(window), mKey(key),
+    mApplied(true)
+{
+    // Nothing to see here.
+}
+
+int ProjectCommand::id() const
+{
+    return mKey.isEmpty() ? -1 : 1;
+}
+
+bool ProjectCommand::mergeWith(const QUndoCommand *other)
+{
+    // Keys name one field or row, so the commands are of the same kind.
+    const ProjectCommand *cmd = static_cast<const ProjectCommand*>(other);
+    if(cmd->mKey != mKey)
+        return false;
+
+    merge(cmd);
+
+    return true;
+}
+
+void ProjectCommand::undo()
+{
+    mWindow->beginRestore();
+    apply(true);
+    mWindow->endRestore();
+}
+
+void ProjectCommand::redo()
+{
+    // QUndoStack::push() calls this for an edit that is already shown.
+    if(mApplied)
+    {
+        mApplied = false;
+        return;
+    }
+
+    mWindow->beginRestore();
+    apply(false);
+    mWindow->endRestore();
+}
+
+OptionsCommand::OptionsCommand(MainWindow *window, const Project& before,
+    const Project& after, const QString& text, const QString& key) :
+    ProjectCommand(window, text, key), mBefore(before), mAfter(after)
+{
+    // Nothing to see here.
+}
+
+void OptionsCommand::apply(bool before)
+{
+    mWindow->setOptions(before ? mBefore : mAfter);
+}
+
+void OptionsCommand::merge(const ProjectCommand *other)
+{
+    mAfter = static_cast<const OptionsCommand*>(other)->mAfter;
+}
+
+CodeCommand::CodeCommand(MainWindow *window, const QString& editor,
+    const QString& before, const QString& after, const QString& text) :
+    ProjectCommand(window, text, editor), mEditor(editor), mBefore(before),
+    mAfter(after)
+{
+    // Nothing to see here.
+}
+
+void CodeCommand::apply(bool before)
+{
+    mWindow->setCode(mEditor, before ? mBefore : mAfter);
+}
+
+void CodeCommand::merge(const ProjectCommand *other)
+{
+    mAfter = static_cast<const CodeCommand*>(other)->mAfter;
+}
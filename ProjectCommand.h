@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROJECTCOMMAND_H
+#define PROJECTCOMMAND_H
+
+#include <QUndoCommand>
+
+#include "ControlSignalModel.h"
+#include "IOSignalModel.h"
+#include "Project.h"
+#include "StateModel.h"
+
+class MainWindow;
+
+/**
+ * One edit of the project, kept as only the part that changed: the
+ * options, one code section or one row of a list. Neither recording nor
+ * undoing an edit copies the whole project. Edits with the same non-empty
+ * key (e.g. typing into one field) merge so a burst of typing undoes in
+ * one step.
+ */
+class ProjectCommand : public QUndoCommand
+{
+public:
+    typedef enum _Action
+    {
+        Action_Edit,
+        Action_Insert,
+        Action_Remove,
+        Action_Up,
+        Action_Down
+    }Action;
+
+    ProjectCommand(MainWindow *window, const QString& text,
+        const QString& key = QString());
+
+    virtual int id() const;
+    virtual bool mergeWith(const QUndoCommand *other);
+
+    virtual void undo();
+    virtual void redo();
+
+protected:
+    /// Show the part as it was before the edit or as the edit left it.
+    virtual void apply(bool before) = 0;
+
+    /// Take the result of a later edit with the same key.
+    virtual void merge(const ProjectCommand *other) = 0;
+
+    MainWindow *mWindow;
+
+private:
+    QString mKey;
+
+    /// The edit was already made in the widgets when it was pushed.
+    bool mApplied;
+};
+
+/// An edit of the options. The projects only carry the options.
+class OptionsCommand : public ProjectCommand
+{
+public:
+    OptionsCommand(MainWindow *window, const Project& before,
+        const Project& after, const QString& text, const QString& key);
+
+protected:
+    virtual void apply(bool before);
+    virtual void merge(const ProjectCommand *other);
+
+private:
+    Project mBefore;
+    Project mAfter;
+};
+
+/// An edit of one of the code sections, named by its editor.
+class CodeCommand : public ProjectCommand
+{
+public:
+    CodeCommand(MainWindow *window, const QString& editor,
+        const QString& before, const QString& after, const QString& text);
+
+protected:
+    virtual void apply(bool before);
+    virtual void merge(const ProjectCommand *other);
+
+private:
+    QString mEditor;
+    QString mBefore;
+    QString mAfter;
+};
+
+/**
+ * An edit of one row of a signal or state list. Only an edit uses both
+ * items, an insert only needs the item after and a remove the item before.
+ * Up and down move the row from the given index.
+ */
+template<class Model, class Item>
+class RowCommand : public ProjectCommand
+{
+public:
+    RowCommand(MainWindow *window, Model *model, Action action, int row,
+        const Item& before, const Item& after, const QString& text,
+        const QString& key = QString()) :
+        ProjectCommand(window, text, key), mModel(model), mAction(action),
+        mRow(row), mBefore(before), mAfter(after)
+    {
+        // Nothing to see here.
+    }
+
+protected:
+    virtual void apply(bool before)
+    {
+        switch(mAction)
+        {
+        case Action_Edit:
+            setRow(before ? mBefore : mAfter);
+            break;
+        case Action_Insert:
+            if(before)
+                removeRow();
+            else
+                mModel->insert(mRow, new Item(mAfter));
+            break;
+        case Action_Remove:
+            if(before)
+                mModel->insert(mRow, new Item(mBefore));
+            else
+                removeRow();
+            break;
+        case Action_Up:
+            if(before)
+                mModel->down(mRow - 1);
+            else
+                mModel->up(mRow);
+            break;
+        case Action_Down:
+            if(before)
+                mModel->up(mRow + 1);
+            else
+                mModel->down(mRow);
+            break;
+        }
+    }
+
+    virtual void merge(const ProjectCommand *other)
+    {
+        mAfter = static_cast<const RowCommand*>(other)->mAfter;
+    }
+
+private:
+    void setRow(const Item& value)
+    {
+        Item *item = mModel->at(mRow);
+        if(!item)
+            return;
+
+        *item = value;
+        mModel->update(mRow);
+    }
+
+    void removeRow()
+    {
+        Item *item = mModel->at(mRow);
+
+        mModel->remove(mRow);
+        delete item;
+    }
+
+    Model *mModel;
+    Action mAction;
+    int mRow;
+
+    Item mBefore;
+    Item mAfter;
+};
+
+typedef RowCommand<IOSignalModel, IOSignal> IOSignalCommand;
+typedef RowCommand<ControlSignalModel, ControlSignal> ControlSignalCommand;
+typedef RowCommand<StateModel, State> StateCommand;
+
+#endif // PROJECTCOMMAND_H
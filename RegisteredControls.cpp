@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RegisteredControls.h"
+
+#include <QtCore/QRegExp>
+
+/// Add every identifier in the code to the set.
+static void addIdentifiers(QSet<QString>& idents, const QString& code)
+{
+    QRegExp ident("[A-Za-z_][A-Za-z0-9_$]*");
+    int pos = 0;
+
+    while((pos = ident.indexIn(code, pos)) != -1)
+    {
+        idents.insert(ident.cap(0));
+        pos += ident.matchedLength();
+    }
+}
+
+RegisteredControls::RegisteredControls(const Project& project,
+    const QStringList& reserved)
+{
+    mStateDefaults = project.stateDefaultsCode().split("\n");
+
+    foreach(const State& state, project.states())
+        mStateCodes.append(state.code().split("\n"));
+
+    foreach(const ControlSignal& sig, project.controlSignals())
+    {
+        if(!sig.registered())
+            continue;
+
+        // Work on copies so a signal that does not qualify leaves the
+        // code untouched.
+        QStringList defaults = mStateDefaults;
+        QList<QStringList> codes = mStateCodes;
+
+        QString defaultsValue;
+        QStringList values;
+
+        // Tasks called from the states and the datapath run outside the
+        // decoder, so they would drive the signal alongside the register.
+        bool ok = !assigns(project.taskCode(), sig.name()) &&
+            !assigns(project.datapathCode(), sig.name()) &&
+            takeAssignments(defaults, sig.name(), defaultsValue);
+
+        for(int i = 0; ok && i < codes.count(); i++)
+        {
+            QString value;
+            ok = takeAssignments(codes[i], sig.name(), value);
+            values.append(value);
+        }
+
+        if(!ok)
+        {
+            mCombinational.append(sig.name());
+            continue;
+        }
+
+        mStateDefaults = defaults;
+        mStateCodes = codes;
+
+        mRegistered.append(sig.name());
+        mDefaults[sig.name()] = "0";
+        mValues[sig.name()] = values;
+    }
+
+    if(mRegistered.isEmpty())
+        return;
+
+    // Names the next value registers could clash with.
+    QSet<QString> taken = reserved.toSet();
+    taken << "current_state" << "next_state" << "ascii_current_state"
+        << "ascii_next_state" << "state_t";
+
+    foreach(const IOSignal& sig, project.ioSignals())
+        taken.insert(sig.name());
+
+    foreach(const ControlSignal& sig, project.controlSignals())
+        taken.insert(sig.name());
+
+    foreach(const State& state, project.states())
+        taken.insert(state.name());
+
+    addIdentifiers(taken, project.headerCode());
+    addIdentifiers(taken, project.datapathCode());
+    addIdentifiers(taken, project.taskCode());
+
+    foreach(const QString& sigName, mRegistered)
+    {
+        QString name = sigName + "_next";
+
+        for(int i = 1; taken.contains(name); i++)
+            name = QString("%1_next_%2").arg(sigName).arg(i);
+
+        taken.insert(name);
+        mNextNames[sigName] = name;
+    }
+}
+
+QStringList RegisteredControls::registered() const
+{
+    return mRegistered;
+}
+
+QStringList RegisteredControls::combinational() const
+{
+    return mCombinational;
+}
+
+bool RegisteredControls::isRegistered(const QString& sigName) const
+{
+    return mDefaults.contains(sigName);
+}
+
+QString RegisteredControls::value(const QString& sigName, int index) const
+{
+    QString val = mValues.value(sigName).value(index);
+    if(val.isEmpty())
+        return defaultValue(sigName);
+
+    return val;
+}
+
+QString RegisteredControls::defaultValue(const QString& sigName) const
+{
+    return mDefaults.value(sigName, "0");
+}
+
+QString RegisteredControls::nextName(const QString& sigName) const
+{
+    return mNextNames.value(sigName, sigName + "_next");
+}
+
+bool RegisteredControls::assignsState(int index) const
+{
+    foreach(const QString& sigName, mRegistered)
+    {
+        if(!mValues.value(sigName).value(index).isEmpty())
+            return true;
+    }
+
+    return false;
+}
+
+QString RegisteredControls::stateCode(int index) const
+{
+    return mStateCodes.value(index).join("\n");
+}
+
+QString RegisteredControls::stateDefaultsCode() const
+{
+    return mStateDefaults.join("\n");
+}
+
+bool RegisteredControls::assigns(const QString& code,
+    const QString& sigName)
+{
+    QRegExp assign(QString("\\b%1\\s*(<=|=(?!=))").arg(
+        QRegExp::escape(sigName)));
+
+    return assign.indexIn(code) != -1;
+}
+
+bool RegisteredControls::takeAssignments(QStringList& lines,
+    const QString& sigName, QString& value)
+{
+    QString name = QRegExp::escape(sigName);
+
+    QRegExp constant(QString("^\\s*%1\\s*=\\s*([0-9]*'?[sS]?[bBoOdDhH]?"
+        "[0-9a-fA-F_xXzZ]+)\\s*;\\s*(//.*)?$").arg(name));
+    QRegExp assign(QString("\\b%1\\s*(<=|=(?!=))").arg(name));
+    QRegExp block("\\b(begin|case|casex|casez|fork|end|endcase|join)\\b");
+    QRegExp header("^if\\b|\\belse\\b|[):]$");
+
+    int depth = 0;
+    bool guarded = false;
+
+    for(int i = 0; i < lines.count(); i++)
+    {
+        QString code = lines.at(i);
+
+        int comment = code.indexOf("//");
+        if(comment >= 0)
+            code.truncate(comment);
+
+        code = code.trimmed();
+        if(code.isEmpty())
+            continue;
+
+        bool topLevel = depth == 0 && !guarded;
+
+        if(topLevel && constant.exactMatch(lines.at(i)))
+        {
+            value = constant.cap(1);
+            lines.removeAt(i--);
+            continue;
+        }
+
+        // Anything else that assigns the signal depends on more than the
+        // state.
+        if(assign.indexIn(code) != -1)
+            return false;
+
+        int pos = 0;
+        while((pos = block.indexIn(code, pos)) != -1)
+        {
+            QString word = block.cap(1);
+
+            if(word.startsWith("end") || word == "join")
+                depth--;
+            else
+                depth++;
+
+            pos += block.matchedLength();
+        }
+
+        // An if, an else (also after an end) or a case item without a
+        // begin guards the next line.
+        guarded = header.indexIn(code) != -1 && !code.endsWith(";") &&
+            !code.contains(QRegExp("\\bbegin\\b"));
+    }
+
+    return true;
+}
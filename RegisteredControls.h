@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REGISTEREDCONTROLS_H
+#define REGISTEREDCONTROLS_H
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include "Project.h"
+
+/**
+ * Works out how to drive the registered control signals of a project from
+ * next_state. A signal can only be registered when every assignment to it
+ * is an unconditional constant at the top level of a state (or the state
+ * defaults), i.e. it is a pure function of the state. Those assignments
+ * are moved out of the state code into a decoder on next_state. Signals
+ * that do not qualify stay combinational, as do signals the task or
+ * datapath code assigns.
+ *
+ * The default is 0 as for a combinational signal, which is set to 0 after
+ * the state defaults run, so a value from the state defaults never shows.
+ */
+class RegisteredControls
+{
+public:
+    /**
+     * Reserved names are other identifiers the module declares, such as
+     * merged states, that the next value registers must not take.
+     */
+    explicit RegisteredControls(const Project& project,
+        const QStringList& reserved = QStringList());
+
+    /// Registered signals in control signal order.
+    QStringList registered() const;
+
+    /// Signals marked as registered that had to stay combinational.
+    QStringList combinational() const;
+
+    bool isRegistered(const QString& sigName) const;
+
+    /// Value of the signal in the state at index (or the default).
+    QString value(const QString& sigName, int index) const;
+    QString defaultValue(const QString& sigName) const;
+
+    /// Name of the variable holding the next value of a registered signal.
+    QString nextName(const QString& sigName) const;
+
+    /// True if any registered signal has a value of its own in the state.
+    bool assignsState(int index) const;
+
+    /// The state code and defaults with the moved assignments removed.
+    QString stateCode(int index) const;
+    QString stateDefaultsCode() const;
+
+private:
+    /// True if the code assigns the signal anywhere.
+    static bool assigns(const QString& code, const QString& sigName);
+
+    static bool takeAssignments(QStringList& lines, const QString& sigName,
+        QString& value);
+
+    QStringList mRegistered;
+    QStringList mCombinational;
+
+    QStringList mStateDefaults;
+    QList<QStringList> mStateCodes;
+
+    QHash<QString, QString> mDefaults;
+    QHash<QString, QStringList> mValues;
+    QHash<QString, QString> mNextNames;
+};
+
+#endif // REGISTEREDCONTROLS_H
@@ -18,47 +18,80 @@
  */
 
 #include "State.h"
-#include "MainWindow.h"
+#include "MappedFile.h"
+#include "StateEncoder.h"
 
 #include <QtCore/QObject>
 
-State::State() : VerilogSignal()
+State::State() : VerilogSignal(), mValue(-1), mCodeOffset(0), mCodeLength(0)
 {
     // Nothing to see here.
 }
 
 QString State::code() const
 {
+    if(mCodeFile)
+        return mCodeFile->text(mCodeOffset, mCodeLength);
+
     return mCode;
 }
 
 void State::setCode(const QString& code)
 {
     mCode = code;
+    mCodeFile.clear();
+    mCodeOffset = 0;
+    mCodeLength = 0;
+}
+
+void State::setCode(const QSharedPointer<const MappedFile>& file,
+    quint32 offset, quint32 length)
+{
+    mCode.clear();
+    mCodeFile = file;
+    mCodeOffset = offset;
+    mCodeLength = length;
 }
 
-QString State::declaration(int bits, int index) const
+int State::value() const
 {
-    return QObject::tr("localparam %1 = %2'd%3;").arg(name()).arg(bits).arg(index);
+    return mValue;
 }
 
-QDomElement State::toXml(QDomDocument doc) const
+void State::setValue(int _value)
 {
-    QDomElement node = doc.createElement("state");
-    node.setAttribute("name", name());
-    node.appendChild(doc.createCDATASection(mCode));
+    mValue = _value < 0 ? -1 : _value;
+}
 
-    return node;
+QString State::declaration(const StateEncoder& encoder, int index) const
+{
+    return QObject::tr("localparam %1 = %2;").arg(name()).arg(encoder.literal(index));
 }
 
-State* State::fromXml(const QDomElement& node)
+void State::write(QXmlStreamWriter& xml) const
 {
+    xml.writeStartElement("state");
+    xml.writeAttribute("name", name());
+    if(mValue >= 0)
+        xml.writeAttribute("value", QString::number(mValue));
+    xml.writeCDATA(code());
+    xml.writeEndElement();
+}
+
+State* State::fromXml(QXmlStreamReader& xml)
+{
+    QXmlStreamAttributes attrs = xml.attributes();
+
     State *state = new State;
-    state->setName(node.attribute("name").trimmed());
-    if(!MainWindow::validIdentifier(state->name()))
+    state->setName(attrs.value("name").toString().trimmed());
+    if(!validIdentifier(state->name()))
         state->setName("invalid_name");
 
-    state->setCode(node.text());
+    bool ok = false;
+    int _value = attrs.value("value").toString().trimmed().toInt(&ok);
+    state->setValue(ok ? _value : -1);
+
+    state->setCode(xml.readElementText(QXmlStreamReader::IncludeChildElements));
 
     return state;
 }
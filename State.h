@@ -20,11 +20,15 @@
 #ifndef STATE_H
 #define STATE_H
 
-#include <QtXml/QDomDocument>
-#include <QtXml/QDomElement>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QXmlStreamReader>
+#include <QtCore/QXmlStreamWriter>
 
 #include "VerilogSignal.h"
 
+class MappedFile;
+class StateEncoder;
+
 class State : public VerilogSignal
 {
 public:
@@ -33,13 +37,31 @@ public:
     QString code() const;
     void setCode(const QString& code);
 
-    QString declaration(int bits, int index) const;
+    /**
+     * Take the code from a range of a mapped binary project. It is only
+     * decoded when code() is called, so large projects load without
+     * touching the code of states nobody looks at.
+     */
+    void setCode(const QSharedPointer<const MappedFile>& file,
+        quint32 offset, quint32 length);
+
+    /// Pinned state vector value or -1 to let the encoder choose.
+    int value() const;
+    void setValue(int value);
 
-    QDomElement toXml(QDomDocument doc) const;
-    static State* fromXml(const QDomElement& node);
+    QString declaration(const StateEncoder& encoder, int index) const;
+
+    void write(QXmlStreamWriter& xml) const;
+    /// Read the element the reader is at. The caller checks the name.
+    static State* fromXml(QXmlStreamReader& xml);
 
 private:
     QString mCode;
+    int mValue;
+
+    QSharedPointer<const MappedFile> mCodeFile;
+    quint32 mCodeOffset;
+    quint32 mCodeLength;
 };
 
 #endif // STATE_H
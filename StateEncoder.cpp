@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StateEncoder.h"
+
+#include <QtCore/QSet>
+
+#include <climits>
+
+static int bitsFor(qint64 count)
+{
+    int bits = 1;
+
+    while(bits < 62 && (Q_INT64_C(1) << bits) < count)
+        bits++;
+
+    return bits;
+}
+
+StateEncoder::StateEncoder(Project::Encoding _encoding,
+    const QList<State>& states) : mEncoding(_encoding)
+{
+    int stateCount = states.count();
+
+    switch(mEncoding)
+    {
+    case Project::Encoding_OneHot:
+        mBits = qMax(1, stateCount);
+        break;
+    case Project::Encoding_Johnson:
+        mBits = qMax(1, (stateCount + 1) / 2);
+        break;
+    default:
+        mBits = bitsFor(stateCount);
+        break;
+    }
+
+    // Collect the pinned values, the first state to claim a value wins.
+    QList<qint64> pins;
+    QSet<qint64> pinned;
+
+    foreach(const State& state, states)
+    {
+        qint64 value = state.value();
+
+        if(mEncoding == Project::Encoding_OneHot || value < 0 ||
+            pinned.contains(value))
+        {
+            pins.append(-1);
+            continue;
+        }
+
+        pins.append(value);
+        pinned.insert(value);
+        mBits = qMax(mBits, bitsFor(value + 1));
+    }
+
+    // Widen the vector until the unpinned states fit around the pinned ones.
+    for(;;)
+    {
+        QSet<QString> used;
+
+        foreach(qint64 value, pinned)
+            used.insert(QString::number(value, 2).rightJustified(mBits, '0'));
+
+        mCodes.clear();
+
+        int k = 0;
+        int cap = capacity();
+        bool fits = true;
+
+        for(int i = 0; i < stateCount; i++)
+        {
+            if(pins.at(i) >= 0)
+            {
+                mCodes.append(QString::number(pins.at(i), 2).rightJustified(
+                    mBits, '0'));
+                continue;
+            }
+
+            while(k < cap && used.contains(sequenceCode(k)))
+                k++;
+
+            if(k >= cap)
+            {
+                fits = false;
+                break;
+            }
+
+            QString c = sequenceCode(k++);
+            used.insert(c);
+            mCodes.append(c);
+        }
+
+        if(fits)
+            break;
+
+        mBits++;
+    }
+}
+
+Project::Encoding StateEncoder::encoding() const
+{
+    return mEncoding;
+}
+
+int StateEncoder::bits() const
+{
+    return mBits;
+}
+
+QString StateEncoder::code(int index) const
+{
+    return mCodes.value(index);
+}
+
+QString StateEncoder::literal(int index) const
+{
+    QString c = code(index);
+
+    // Binary keeps the decimal form it has always been written in.
+    if(mEncoding == Project::Encoding_Binary)
+    {
+        bool ok = false;
+        qulonglong value = c.toULongLong(&ok, 2);
+
+        if(ok)
+            return QString("%1'd%2").arg(mBits).arg(value);
+    }
+
+    return QString("%1'b%2").arg(mBits).arg(c);
+}
+
+QString StateEncoder::sequenceCode(int k) const
+{
+    switch(mEncoding)
+    {
+    case Project::Encoding_OneHot:
+    {
+        QString c(mBits, QChar('0'));
+        c[mBits - k - 1] = QChar('1');
+        return c;
+    }
+    case Project::Encoding_Gray:
+        return QString::number(k ^ (k >> 1), 2).rightJustified(mBits, '0');
+    case Project::Encoding_Johnson:
+        // Fill with ones from the right, then shift zeros in: 000, 001,
+        // 011, 111, 110, 100.
+        if(k <= mBits)
+            return QString(mBits - k, QChar('0')) + QString(k, QChar('1'));
+
+        return QString(2 * mBits - k, QChar('1')) +
+            QString(k - mBits, QChar('0'));
+    default:
+        return QString::number(k, 2).rightJustified(mBits, '0');
+    }
+}
+
+int StateEncoder::capacity() const
+{
+    switch(mEncoding)
+    {
+    case Project::Encoding_OneHot:
+        return mBits;
+    case Project::Encoding_Johnson:
+        return 2 * mBits;
+    default:
+        return mBits >= 31 ? INT_MAX : (1 << mBits);
+    }
+}
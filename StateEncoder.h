@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STATEENCODER_H
+#define STATEENCODER_H
+
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include "Project.h"
+
+/**
+ * Assigns a code to every state for the chosen encoding. States with a
+ * pinned value keep it (except with one-hot, where the bit position is the
+ * code) and the remaining states take the next free codes of the encoding
+ * in list order. If a pinned value is used twice only the first state keeps
+ * it.
+ */
+class StateEncoder
+{
+public:
+    StateEncoder(Project::Encoding encoding, const QList<State>& states);
+
+    Project::Encoding encoding() const;
+
+    /// Width of the state vector.
+    int bits() const;
+
+    /// Code of the state at index as a string of bits, MSB first.
+    QString code(int index) const;
+
+    /// Code of the state at index as a Verilog literal.
+    QString literal(int index) const;
+
+private:
+    QString sequenceCode(int k) const;
+    int capacity() const;
+
+    Project::Encoding mEncoding;
+    int mBits;
+    QStringList mCodes;
+};
+
+#endif // STATEENCODER_H
@@ -18,6 +18,7 @@
  */
 
 #include "StateModel.h"
+#include "SymbolTable.h"
 
 StateModel::StateModel(QObject *parent) :
     QAbstractListModel(parent)
@@ -41,7 +42,7 @@ QVariant StateModel::data(const QModelIndex& index, int role) const
     if(index.row() < 0 || index.row() >= mStates.count())
         return QVariant();
 
-    if(role != Qt::DisplayRole)
+    if(role != Qt::DisplayRole && role != SymbolTable::Role_Name)
         return QVariant();
 
     State *sig = mStates.at(index.row());
@@ -69,6 +70,78 @@ void StateModel::append(State *sig)
     endInsertRows();
 }
 
+void StateModel::insert(int index, State *sig)
+{
+    if(contains(sig->name()))
+        return;
+
+    index = qBound(0, index, mStates.count());
+
+    beginInsertRows(QModelIndex(), index, index);
+    mStates.insert(index, sig);
+    mStatesByName[sig->name()] = sig;
+    endInsertRows();
+}
+
+void StateModel::appendMany(const QList<State*>& states)
+{
+    QList<State*> added;
+    added.reserve(states.count());
+
+    // Names go in first so duplicates within the batch are caught as well.
+    mStatesByName.reserve(mStatesByName.count() + states.count());
+
+    foreach(State *sig, states)
+    {
+        if(contains(sig->name()))
+        {
+            delete sig;
+            continue;
+        }
+
+        mStatesByName.insert(sig->name(), sig);
+        added.append(sig);
+    }
+
+    if(added.isEmpty())
+        return;
+
+    int row = mStates.count();
+
+    beginInsertRows(QModelIndex(), row, row + added.count() - 1);
+    mStates.reserve(row + added.count());
+    mStates.append(added);
+    endInsertRows();
+}
+
+void StateModel::replaceAll(const QList<State*>& states)
+{
+    beginResetModel();
+
+    foreach(State *sig, mStates)
+        delete sig;
+
+    mStates.clear();
+    mStatesByName.clear();
+
+    mStates.reserve(states.count());
+    mStatesByName.reserve(states.count());
+
+    foreach(State *sig, states)
+    {
+        if(contains(sig->name()))
+        {
+            delete sig;
+            continue;
+        }
+
+        mStates.append(sig);
+        mStatesByName.insert(sig->name(), sig);
+    }
+
+    endResetModel();
+}
+
 void StateModel::up(int index)
 {
     if(index < 1 || index >= mStates.count())
@@ -133,18 +206,10 @@ void StateModel::update(int index)
     }
 
     emit dataChanged(this->index(index), this->index(index),
-        QVector<int>() << Qt::DisplayRole);
+        QVector<int>() << Qt::DisplayRole << SymbolTable::Role_Name);
 }
 
 void StateModel::clear()
 {
-    beginResetModel();
-
-    foreach(State *sig, mStates)
-        delete sig;
-
-    mStates.clear();
-    mStatesByName.clear();
-
-    endResetModel();
+    replaceAll(QList<State*>());
 }
@@ -39,6 +39,18 @@ public:
     bool contains(const QString& sigName) const;
     void append(State *sig);
 
+    /// Insert at the given row, as append() does at the end.
+    void insert(int index, State *sig);
+
+    /**
+     * Append several states with a single insert. The model owns them
+     * afterwards and deletes any whose name is already taken.
+     */
+    void appendMany(const QList<State*>& states);
+
+    /// Replace every state with a single reset. Takes ownership as above.
+    void replaceAll(const QList<State*>& states);
+
     void up(int index);
     void down(int index);
     void remove(int index);
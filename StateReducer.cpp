@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StateReducer.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QRegExp>
+#include <QtCore/QSet>
+
+/// Add every identifier in the code to the set.
+static void addIdentifiers(QSet<QString>& idents, const QString& code)
+{
+    QRegExp ident("[A-Za-z_][A-Za-z0-9_$]*");
+    int pos = 0;
+
+    while((pos = ident.indexIn(code, pos)) != -1)
+    {
+        idents.insert(ident.cap(0));
+        pos += ident.matchedLength();
+    }
+}
+
+/// The code with comments and next_state targets taken out and the
+/// whitespace collapsed. The targets are appended to the list in order.
+static QString normalizedCode(const QString& code, QStringList& targets)
+{
+    QString str = code;
+
+    QRegExp blockComment("/\\*.*\\*/");
+    blockComment.setMinimal(true);
+
+    str.remove(blockComment);
+    str.remove(QRegExp("//[^\n]*"));
+
+    QRegExp assign("\\bnext_state\\s*(<=|=(?!=))\\s*([^;]*);");
+    int pos = 0;
+
+    while((pos = assign.indexIn(str, pos)) != -1)
+    {
+        targets.append(assign.cap(2).simplified());
+
+        QString placeholder = QString("next_state %1 @;").arg(assign.cap(1));
+        str.replace(pos, assign.matchedLength(), placeholder);
+        pos += placeholder.length();
+    }
+
+    return str.simplified();
+}
+
+/// Add the identifiers in the code to the set, leaving out the next_state
+/// targets that are plain names.
+static void addNamedIdentifiers(QSet<QString>& idents, const QString& code)
+{
+    QStringList targets;
+    addIdentifiers(idents, normalizedCode(code, targets));
+
+    QRegExp plain("[A-Za-z_][A-Za-z0-9_$]*");
+
+    foreach(const QString& target, targets)
+    {
+        if(!plain.exactMatch(target))
+            addIdentifiers(idents, target);
+    }
+}
+
+StateReducer::StateReducer(const Project& project,
+    const TransitionGraph& graph) : mReduced(project)
+{
+    if(project.removeUnreachable())
+        removeUnreachable(graph);
+
+    if(project.mergeEquivalent())
+        mergeEquivalent();
+}
+
+void StateReducer::removeUnreachable(const TransitionGraph& graph)
+{
+    Project project = mReduced;
+
+    QList<State> states = project.states();
+
+    int resetIndex = graph.indexOf(project.resetState());
+    if(resetIndex < 0)
+    {
+        mKeptReason = "there is no reset state";
+        return;
+    }
+
+    QList<int> from;
+    from.append(resetIndex);
+
+    // The defaults and tasks run in every state so their targets are
+    // reachable whenever any state is.
+    QList<TransitionGraph::Transition> shared = graph.sharedTransitions();
+
+    QList<TransitionGraph::Transition> transitions =
+        graph.transitions() + shared;
+
+    foreach(const TransitionGraph::Transition& trans, transitions)
+    {
+        int to = trans.to;
+
+        if(to < 0)
+        {
+            mKeptReason = QString("next_state is assigned \"%1\"").arg(
+                trans.target);
+            return;
+        }
+
+        if(trans.from < 0)
+            from.append(to);
+    }
+
+    QList<bool> keep;
+    for(int i = 0; i < states.count(); i++)
+        keep.append(false);
+
+    foreach(int index, graph.reachable(from))
+    {
+        keep[index] = true;
+
+        if(shared.isEmpty() && graph.targets(index).isEmpty() &&
+            index != resetIndex)
+            mDeadEnds.append(states.at(index).name());
+    }
+
+    // Removing a state that some kept code names would leave an undeclared
+    // identifier behind, so keep those too.
+    QSet<QString> idents;
+    addIdentifiers(idents, project.headerCode());
+    addIdentifiers(idents, project.datapathCode());
+    addIdentifiers(idents, project.taskCode());
+    addIdentifiers(idents, project.stateDefaultsCode());
+
+    for(int i = 0; i < states.count(); i++)
+    {
+        if(keep.at(i))
+            addIdentifiers(idents, states.at(i).code());
+    }
+
+    bool changed = true;
+    while(changed)
+    {
+        changed = false;
+
+        for(int i = 0; i < states.count(); i++)
+        {
+            if(!keep.at(i) && idents.contains(states.at(i).name()))
+            {
+                keep[i] = true;
+                addIdentifiers(idents, states.at(i).code());
+                changed = true;
+            }
+        }
+    }
+
+    QList<State> kept;
+
+    for(int i = 0; i < states.count(); i++)
+    {
+        if(keep.at(i))
+            kept.append(states.at(i));
+        else
+            mRemoved.append(states.at(i).name());
+    }
+
+    mReduced.setStates(kept);
+}
+
+void StateReducer::mergeEquivalent()
+{
+    QList<State> states = mReduced.states();
+
+    // Unreachable states may have been removed, so the indices here are not
+    // the graph's.
+    QHash<QString, int> stateIndex;
+    for(int i = 0; i < states.count(); i++)
+        stateIndex.insert(states.at(i).name(), i);
+
+    // A state named anywhere but as a next_state target, for example in a
+    // current_state comparison, would change meaning once it is an alias.
+    QSet<QString> named;
+    addNamedIdentifiers(named, mReduced.headerCode());
+    addNamedIdentifiers(named, mReduced.datapathCode());
+    addNamedIdentifiers(named, mReduced.taskCode());
+    addNamedIdentifiers(named, mReduced.stateDefaultsCode());
+
+    foreach(const State& state, states)
+        addNamedIdentifiers(named, state.code());
+
+    QList<QStringList> targets;
+    QList<int> blocks;
+
+    // Start with one block per distinct piece of code, ignoring where the
+    // code goes next. Named states get a block of their own.
+    QHash<QString, int> codeBlocks;
+
+    for(int i = 0; i < states.count(); i++)
+    {
+        QStringList stateTargets;
+        QString code = normalizedCode(states.at(i).code(), stateTargets);
+
+        // Normalized code has no line breaks, so this never matches code.
+        if(named.contains(states.at(i).name()))
+            code = states.at(i).name() + "\n";
+
+        if(!codeBlocks.contains(code))
+            codeBlocks.insert(code, codeBlocks.count());
+
+        targets.append(stateTargets);
+        blocks.append(codeBlocks.value(code));
+    }
+
+    // Split the blocks until the states in each one go to the same blocks.
+    int blockCount = codeBlocks.count();
+
+    while(true)
+    {
+        QHash<QString, int> newBlocks;
+        QList<int> split;
+
+        for(int i = 0; i < states.count(); i++)
+        {
+            QString key = QString::number(blocks.at(i));
+
+            foreach(const QString& target, targets.at(i))
+            {
+                int index = stateIndex.value(target, -1);
+
+                if(index < 0)
+                    key += " " + target;
+                else
+                    key += QString(" #%1").arg(blocks.at(index));
+            }
+
+            if(!newBlocks.contains(key))
+                newBlocks.insert(key, newBlocks.count());
+
+            split.append(newBlocks.value(key));
+        }
+
+        blocks = split;
+
+        if(newBlocks.count() == blockCount)
+            break;
+
+        blockCount = newBlocks.count();
+    }
+
+    if(blockCount == states.count())
+        return;
+
+    // The reset state stands for its block so the reset still names a
+    // declared state, otherwise the first state of the block does.
+    QHash<int, int> representative;
+
+    int resetIndex = stateIndex.value(mReduced.resetState(), -1);
+    if(resetIndex >= 0)
+        representative.insert(blocks.at(resetIndex), resetIndex);
+
+    for(int i = 0; i < states.count(); i++)
+    {
+        if(!representative.contains(blocks.at(i)))
+            representative.insert(blocks.at(i), i);
+    }
+
+    QList<State> kept;
+
+    for(int i = 0; i < states.count(); i++)
+    {
+        int into = representative.value(blocks.at(i));
+
+        if(into == i)
+        {
+            kept.append(states.at(i));
+        }
+        else
+        {
+            Merge merge;
+            merge.state = states.at(i).name();
+            merge.into = states.at(into).name();
+            mMerged.append(merge);
+        }
+    }
+
+    mReduced.setStates(kept);
+}
+
+Project StateReducer::reduced() const
+{
+    return mReduced;
+}
+
+QStringList StateReducer::removed() const
+{
+    return mRemoved;
+}
+
+QStringList StateReducer::deadEnds() const
+{
+    return mDeadEnds;
+}
+
+QList<StateReducer::Merge> StateReducer::merged() const
+{
+    return mMerged;
+}
+
+QString StateReducer::report() const
+{
+    QString str;
+
+    if(!mKeptReason.isEmpty())
+    {
+        str += QString("// Unreachable states were not removed: %1\n").arg(
+            mKeptReason);
+    }
+
+    if(!mRemoved.isEmpty())
+    {
+        str += QString("// Unreachable states removed: %1\n").arg(
+            mRemoved.join(", "));
+    }
+
+    if(!mDeadEnds.isEmpty())
+    {
+        str += QString("// States only left by reset: %1\n").arg(
+            mDeadEnds.join(", "));
+    }
+
+    if(!mMerged.isEmpty())
+    {
+        QStringList merges;
+        foreach(const Merge& merge, mMerged)
+            merges.append(QString("%1 into %2").arg(merge.state).arg(merge.into));
+
+        str += QString("// Equivalent states merged: %1\n").arg(
+            merges.join(", "));
+    }
+
+    return str;
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STATEREDUCER_H
+#define STATEREDUCER_H
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include "Project.h"
+#include "TransitionGraph.h"
+
+/**
+ * Removes the states that can never be entered from a project before it is
+ * generated. A state is kept when it can be reached from the reset state
+ * through the next_state assignments or when other code refers to it by
+ * name. If any next_state assignment is not a plain state name nothing is
+ * removed since the reachable states can not be known.
+ *
+ * Equivalent states, those with the same code going to equivalent states,
+ * are merged into one by partition refinement. The merged states are kept
+ * as aliases of the state that replaced them. A state whose name appears
+ * anywhere but as a next_state target is never merged, since an alias
+ * would change what that code means.
+ */
+class StateReducer
+{
+public:
+    typedef struct _Merge
+    {
+        QString state;
+        QString into;
+    }Merge;
+
+    /// The graph must have been built from the same project.
+    StateReducer(const Project& project, const TransitionGraph& graph);
+
+    /// The project without the unreachable states.
+    Project reduced() const;
+
+    QStringList removed() const;
+
+    /// Reachable states that are only ever left by a reset.
+    QStringList deadEnds() const;
+
+    QList<Merge> merged() const;
+
+    /// What was removed as comment lines for the generated module.
+    QString report() const;
+
+private:
+    void removeUnreachable(const TransitionGraph& graph);
+    void mergeEquivalent();
+
+    Project mReduced;
+
+    QStringList mRemoved;
+    QStringList mDeadEnds;
+    QString mKeptReason;
+    QList<Merge> mMerged;
+};
+
+#endif // STATEREDUCER_H
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SymbolTable.h"
+
+#include <QtCore/QAbstractItemModel>
+#include <QtCore/QTimer>
+
+SymbolTable::SymbolTable(QObject *parent) : QObject(parent),
+    mUpdatePending(false)
+{
+    // Nothing to see here.
+}
+
+void SymbolTable::addModel(QAbstractItemModel *model, Kind kind)
+{
+    mModels.append(model);
+    mModelKinds.append(kind);
+
+    connect(model, SIGNAL(rowsInserted(QModelIndex, int, int)),
+        this, SLOT(scheduleUpdate()));
+    connect(model, SIGNAL(rowsRemoved(QModelIndex, int, int)),
+        this, SLOT(scheduleUpdate()));
+    connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex, QVector<int>)),
+        this, SLOT(scheduleUpdate()));
+    connect(model, SIGNAL(modelReset()), this, SLOT(scheduleUpdate()));
+
+    scheduleUpdate();
+}
+
+SymbolTable::Kind SymbolTable::kind(const QString& name) const
+{
+    return mSymbols.value(name, Kind_None);
+}
+
+void SymbolTable::scheduleUpdate()
+{
+    if(mUpdatePending)
+        return;
+
+    mUpdatePending = true;
+    QTimer::singleShot(0, this, SLOT(update()));
+}
+
+void SymbolTable::update()
+{
+    mUpdatePending = false;
+
+    QHash<QString, Kind> symbols;
+
+    for(int i = 0; i < mModels.count(); i++)
+    {
+        QAbstractItemModel *model = mModels.at(i);
+        int rows = model->rowCount();
+
+        for(int row = 0; row < rows; row++)
+        {
+            QString name = model->data(model->index(row, 0),
+                Role_Name).toString();
+
+            if(!name.isEmpty() && !symbols.contains(name))
+                symbols.insert(name, mModelKinds.at(i));
+        }
+    }
+
+    QSet<QString> changed;
+
+    QHash<QString, Kind>::const_iterator it;
+    for(it = symbols.constBegin(); it != symbols.constEnd(); ++it)
+    {
+        if(mSymbols.value(it.key(), Kind_None) != it.value())
+            changed.insert(it.key());
+    }
+
+    for(it = mSymbols.constBegin(); it != mSymbols.constEnd(); ++it)
+    {
+        if(!symbols.contains(it.key()))
+            changed.insert(it.key());
+    }
+
+    mSymbols = symbols;
+
+    if(!changed.isEmpty())
+        emit symbolsChanged(changed);
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYMBOLTABLE_H
+#define SYMBOLTABLE_H
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+
+class QAbstractItemModel;
+
+/**
+ * The names of the signals and states in the open project, kept up to date
+ * from the list models. Changes to the models are batched until control
+ * returns to the event loop, so loading a project rebuilds the table once
+ * rather than once per row.
+ */
+class SymbolTable : public QObject
+{
+    Q_OBJECT
+public:
+    typedef enum _Kind
+    {
+        Kind_None = 0,
+        Kind_Signal,
+        Kind_State
+    }Kind;
+
+    /// Models give the bare name of each row for this role.
+    typedef enum _Role
+    {
+        Role_Name = Qt::UserRole
+    }Role;
+
+    explicit SymbolTable(QObject *parent = 0);
+
+    /// Track the names of a model as symbols of the given kind.
+    void addModel(QAbstractItemModel *model, Kind kind);
+
+    Kind kind(const QString& name) const;
+
+signals:
+    /// Emitted with every name that was added, removed or changed kind.
+    void symbolsChanged(const QSet<QString>& names);
+
+private slots:
+    void scheduleUpdate();
+    void update();
+
+private:
+    QList<QAbstractItemModel*> mModels;
+    QList<Kind> mModelKinds;
+
+    QHash<QString, Kind> mSymbols;
+    bool mUpdatePending;
+};
+
+#endif // SYMBOLTABLE_H
@@ -0,0 +1,564 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TransitionGraph.h"
+
+namespace
+{
+
+typedef struct _Token
+{
+    QString text;
+    int start;
+    int end;
+}Token;
+
+/// Split the code into identifiers, numbers and operators.
+QList<Token> tokenize(const QString& code)
+{
+    QList<Token> tokens;
+
+    const QChar *data = code.constData();
+    int len = code.length();
+    int i = 0;
+
+    while(i < len)
+    {
+        QChar c = data[i];
+
+        if(c.isSpace())
+        {
+            i++;
+            continue;
+        }
+
+        // Comments.
+        if(c == '/' && i + 1 < len && data[i + 1] == '/')
+        {
+            while(i < len && data[i] != '\n')
+                i++;
+            continue;
+        }
+
+        if(c == '/' && i + 1 < len && data[i + 1] == '*')
+        {
+            int end = code.indexOf("*/", i + 2);
+            i = end < 0 ? len : end + 2;
+            continue;
+        }
+
+        Token tok;
+        tok.start = i;
+
+        if(c == '"')
+        {
+            i++;
+            while(i < len && data[i] != '"')
+            {
+                if(data[i] == '\\')
+                    i++;
+                i++;
+            }
+            i = qMin(i + 1, len);
+        }
+        else if(c.isLetter() || c == '_' || c == '$' || c == '`')
+        {
+            i++;
+            while(i < len && (data[i].isLetterOrNumber() || data[i] == '_' ||
+                data[i] == '$'))
+            {
+                i++;
+            }
+        }
+        else if(c == '\\')
+        {
+            // Escaped identifiers run to the next white space.
+            while(i < len && !data[i].isSpace())
+                i++;
+        }
+        else if(c.isDigit() || c == '\'')
+        {
+            i++;
+            while(i < len && (data[i].isLetterOrNumber() || data[i] == '_' ||
+                data[i] == '\'' || data[i] == '?'))
+            {
+                i++;
+            }
+        }
+        else
+        {
+            static const char *ops[] = { "===", "!==", "==", "!=", "<=", ">=",
+                "&&", "||", "<<", ">>", 0 };
+
+            int opLen = 1;
+
+            for(int j = 0; ops[j]; j++)
+            {
+                QLatin1String op(ops[j]);
+                int n = (int)qstrlen(ops[j]);
+
+                if(QStringRef(&code, i, qMin(n, len - i)) == op)
+                {
+                    opLen = n;
+                    break;
+                }
+            }
+
+            i += opLen;
+        }
+
+        tok.end = i;
+        tok.text = code.mid(tok.start, tok.end - tok.start);
+        tokens.append(tok);
+    }
+
+    return tokens;
+}
+
+class Parser
+{
+public:
+    Parser(const QString& code) : mCode(code), mTokens(tokenize(code)),
+        mPos(0)
+    {
+        // Nothing to see here.
+    }
+
+    QList<TransitionGraph::Transition> parse()
+    {
+        while(mPos < mTokens.count())
+        {
+            int start = mPos;
+            statement(QStringList());
+
+            // Stray end or endcase, skip it.
+            if(mPos == start)
+                mPos++;
+        }
+
+        return mTransitions;
+    }
+
+private:
+    bool at(const char *text) const
+    {
+        return mPos < mTokens.count() && mTokens.at(mPos).text == QLatin1String(text);
+    }
+
+    bool accept(const char *text)
+    {
+        if(!at(text))
+            return false;
+
+        mPos++;
+        return true;
+    }
+
+    /// Text of a parenthesised expression, leaving mPos after the ")".
+    QString parenthesised()
+    {
+        if(!at("("))
+            return QString();
+
+        int start = mTokens.at(mPos).end;
+        int depth = 0;
+
+        while(mPos < mTokens.count())
+        {
+            const QString& text = mTokens.at(mPos).text;
+
+            if(text == "(")
+            {
+                depth++;
+            }
+            else if(text == ")" && --depth == 0)
+            {
+                int end = mTokens.at(mPos).start;
+                mPos++;
+
+                return mCode.mid(start, end - start).simplified();
+            }
+
+            mPos++;
+        }
+
+        return mCode.mid(start).simplified();
+    }
+
+    /// Skip a simple statement up to and including its ";".
+    void skipStatement()
+    {
+        int depth = 0;
+
+        while(mPos < mTokens.count())
+        {
+            const QString& text = mTokens.at(mPos).text;
+
+            if(text == "(" || text == "[" || text == "{")
+                depth++;
+            else if(text == ")" || text == "]" || text == "}")
+                depth--;
+
+            if(depth <= 0 && (text == "end" || text == "endcase"))
+                return;
+
+            mPos++;
+
+            if(depth <= 0 && text == ";")
+                return;
+        }
+    }
+
+    static QString join(const QStringList& conditions)
+    {
+        if(conditions.count() == 1)
+            return conditions.first();
+
+        QStringList parts;
+        foreach(const QString& cond, conditions)
+            parts.append(QString("(%1)").arg(cond));
+
+        return parts.join(" && ");
+    }
+
+    void statement(const QStringList& conditions)
+    {
+        if(mPos >= mTokens.count() || at("end") || at("endcase") ||
+            at("else"))
+        {
+            return;
+        }
+
+        if(accept(";"))
+            return;
+
+        if(accept("begin"))
+        {
+            // Optional block name.
+            if(accept(":"))
+                mPos++;
+
+            while(mPos < mTokens.count() && !at("end") && !at("endcase"))
+            {
+                int start = mPos;
+                statement(conditions);
+
+                if(mPos == start)
+                    mPos++;
+            }
+
+            accept("end");
+            if(accept(":"))
+                mPos++;
+
+            return;
+        }
+
+        // The SystemVerilog qualifiers only add checks, the case or if they
+        // qualify goes the same way.
+        if(!accept("unique") && !accept("unique0"))
+            accept("priority");
+
+        if(accept("if"))
+        {
+            QString cond = parenthesised();
+
+            QStringList thenConditions = conditions;
+            thenConditions.append(cond);
+            statement(thenConditions);
+
+            if(accept("else"))
+            {
+                QStringList elseConditions = conditions;
+                elseConditions.append(QString("!(%1)").arg(cond));
+                statement(elseConditions);
+            }
+
+            return;
+        }
+
+        if(at("case") || at("casex") || at("casez"))
+        {
+            caseStatement(conditions);
+            return;
+        }
+
+        if(accept("for") || accept("while") || accept("repeat"))
+        {
+            parenthesised();
+            statement(conditions);
+            return;
+        }
+
+        if(at("next_state") && mPos + 2 < mTokens.count() &&
+            (mTokens.at(mPos + 1).text == "=" ||
+            mTokens.at(mPos + 1).text == "<="))
+        {
+            // Anything other than a plain state name is kept as written so
+            // callers can tell the target is not known.
+            mPos += 2;
+
+            int start = mTokens.at(mPos).start;
+            skipStatement();
+
+            int end = mTokens.at(mPos - 1).text == ";" ?
+                mTokens.at(mPos - 1).start : mTokens.at(mPos - 1).end;
+            end = qMax(start, end);
+
+            TransitionGraph::Transition trans;
+            trans.from = -1;
+            trans.to = -1;
+            trans.target = mCode.mid(start, end - start).simplified();
+            trans.condition = conditions.isEmpty() ? QString() :
+                join(conditions);
+            mTransitions.append(trans);
+
+            return;
+        }
+
+        skipStatement();
+    }
+
+    void caseStatement(const QStringList& conditions)
+    {
+        mPos++;
+
+        QString subject = parenthesised();
+        QStringList previous;
+
+        while(mPos < mTokens.count() && !at("endcase"))
+        {
+            QStringList itemConditions = conditions;
+
+            if(accept("default"))
+            {
+                accept(":");
+
+                foreach(const QString& item, previous)
+                    itemConditions.append(QString("!(%1)").arg(item));
+            }
+            else
+            {
+                // Case item labels up to the ":".
+                int start = mTokens.at(mPos).start;
+                int depth = 0;
+
+                while(mPos < mTokens.count())
+                {
+                    const QString& text = mTokens.at(mPos).text;
+
+                    if(text == "(" || text == "[" || text == "{")
+                        depth++;
+                    else if(text == ")" || text == "]" || text == "}")
+                        depth--;
+                    else if(depth == 0 && text == ":")
+                        break;
+                    else if(text == "endcase")
+                        return;
+
+                    mPos++;
+                }
+
+                int end = mPos < mTokens.count() ? mTokens.at(mPos).start :
+                    mCode.length();
+                accept(":");
+
+                QStringList labels;
+                foreach(QString label, mCode.mid(start, end - start).split(","))
+                    labels.append(QString("%1 == %2").arg(subject).arg(label.simplified()));
+
+                QString item = labels.join(" || ");
+                previous.append(item);
+                itemConditions.append(item);
+            }
+
+            int start = mPos;
+            statement(itemConditions);
+
+            if(mPos == start && !at("endcase"))
+                mPos++;
+        }
+
+        accept("endcase");
+    }
+
+    QString mCode;
+    QList<Token> mTokens;
+    int mPos;
+
+    QList<TransitionGraph::Transition> mTransitions;
+};
+
+} // namespace
+
+TransitionGraph::TransitionGraph()
+{
+    // Nothing to see here.
+}
+
+TransitionGraph::TransitionGraph(const QList<State>& states)
+{
+    addStates(states);
+}
+
+TransitionGraph::TransitionGraph(const Project& project)
+{
+    addStates(project.states());
+    addShared(project.stateDefaultsCode());
+    addShared(project.taskCode());
+}
+
+void TransitionGraph::addStates(const QList<State>& states)
+{
+    for(int i = 0; i < states.count(); i++)
+    {
+        mStateNames.append(states.at(i).name());
+        mStateIndex[states.at(i).name()] = i;
+
+        mTransitionsFrom.append(QList<int>());
+        mTargets.append(QList<int>());
+        mSources.append(QList<int>());
+    }
+
+    for(int i = 0; i < states.count(); i++)
+    {
+        foreach(Transition trans, parse(states.at(i).code()))
+        {
+            trans.from = i;
+            trans.to = mStateIndex.value(trans.target, -1);
+
+            mTransitionsFrom[i].append(mTransitions.count());
+            mTransitions.append(trans);
+
+            if(trans.to < 0 || trans.to == i)
+                continue;
+
+            if(!mTargets.at(i).contains(trans.to))
+                mTargets[i].append(trans.to);
+
+            // Sources are added in state order so duplicates are adjacent.
+            if(mSources.at(trans.to).isEmpty() ||
+                mSources.at(trans.to).last() != i)
+            {
+                mSources[trans.to].append(i);
+            }
+        }
+    }
+}
+
+void TransitionGraph::addShared(const QString& code)
+{
+    foreach(Transition trans, parse(code))
+    {
+        trans.from = -1;
+        trans.to = mStateIndex.value(trans.target, -1);
+
+        mShared.append(trans);
+    }
+}
+
+int TransitionGraph::stateCount() const
+{
+    return mStateNames.count();
+}
+
+QString TransitionGraph::stateName(int index) const
+{
+    return mStateNames.value(index);
+}
+
+int TransitionGraph::indexOf(const QString& stateName) const
+{
+    return mStateIndex.value(stateName, -1);
+}
+
+QList<TransitionGraph::Transition> TransitionGraph::transitions() const
+{
+    return mTransitions;
+}
+
+QList<TransitionGraph::Transition> TransitionGraph::transitionsFrom(
+    int index) const
+{
+    QList<Transition> list;
+
+    foreach(int trans, mTransitionsFrom.value(index))
+        list.append(mTransitions.at(trans));
+
+    return list;
+}
+
+QList<TransitionGraph::Transition> TransitionGraph::sharedTransitions() const
+{
+    return mShared;
+}
+
+QList<int> TransitionGraph::targets(int index) const
+{
+    return mTargets.value(index);
+}
+
+QList<int> TransitionGraph::sources(int index) const
+{
+    return mSources.value(index);
+}
+
+QList<int> TransitionGraph::reachable(const QList<int>& from) const
+{
+    QList<bool> seen;
+    for(int i = 0; i < mStateNames.count(); i++)
+        seen.append(false);
+
+    QList<int> pending;
+
+    foreach(int index, from)
+    {
+        if(index >= 0 && index < seen.count() && !seen.at(index))
+        {
+            seen[index] = true;
+            pending.append(index);
+        }
+    }
+
+    while(!pending.isEmpty())
+    {
+        foreach(int target, mTargets.at(pending.takeLast()))
+        {
+            if(!seen.at(target))
+            {
+                seen[target] = true;
+                pending.append(target);
+            }
+        }
+    }
+
+    QList<int> list;
+    for(int i = 0; i < seen.count(); i++)
+    {
+        if(seen.at(i))
+            list.append(i);
+    }
+
+    return list;
+}
+
+QList<TransitionGraph::Transition> TransitionGraph::parse(const QString& code)
+{
+    return Parser(code).parse();
+}
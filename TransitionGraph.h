@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRANSITIONGRAPH_H
+#define TRANSITIONGRAPH_H
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include "Project.h"
+#include "State.h"
+
+/**
+ * The state transitions of an FSM, taken from the next_state assignments
+ * in each state's code. The parser only understands the statements that
+ * can guard an assignment (begin/end, if/else and case) and skips
+ * everything else up to the next semicolon, so it runs in a single pass
+ * over the code.
+ *
+ * Built from a project the graph also holds the transitions in the state
+ * defaults and task code, which run in every state.
+ */
+class TransitionGraph
+{
+public:
+    typedef struct _Transition
+    {
+        /// Index of the source and target state, -1 if unknown.
+        int from;
+        int to;
+
+        /// Target as written in the code.
+        QString target;
+
+        /// Guarding condition, empty when the assignment is unconditional.
+        QString condition;
+    }Transition;
+
+    TransitionGraph();
+    explicit TransitionGraph(const QList<State>& states);
+    explicit TransitionGraph(const Project& project);
+
+    int stateCount() const;
+    QString stateName(int index) const;
+    int indexOf(const QString& stateName) const;
+
+    QList<Transition> transitions() const;
+    QList<Transition> transitionsFrom(int index) const;
+
+    /// Transitions in the state defaults and task code, with a from of -1.
+    QList<Transition> sharedTransitions() const;
+
+    /// Distinct target states, not counting staying in the same state.
+    QList<int> targets(int index) const;
+
+    /// Distinct source states, not counting staying in the same state.
+    QList<int> sources(int index) const;
+
+    /// States reachable from any of the given states, in index order.
+    QList<int> reachable(const QList<int>& from) const;
+
+    /**
+     * Parse one block of state code. The returned transitions only have
+     * the target and condition filled in.
+     */
+    static QList<Transition> parse(const QString& code);
+
+private:
+    void addStates(const QList<State>& states);
+    void addShared(const QString& code);
+
+    QStringList mStateNames;
+    QHash<QString, int> mStateIndex;
+
+    QList<Transition> mTransitions;
+    QList<Transition> mShared;
+    QList<QList<int> > mTransitionsFrom;
+    QList<QList<int> > mTargets;
+    QList<QList<int> > mSources;
+};
+
+#endif // TRANSITIONGRAPH_H
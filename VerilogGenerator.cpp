@@ -0,0 +1,652 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "VerilogGenerator.h"
+#include "FsmPass.h"
+#include "RegisteredControls.h"
+#include "StateEncoder.h"
+#include "VerilogWriter.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <QtCore/QBuffer>
+#include <QtCore/QThreadPool>
+
+/// Machines smaller than this are not worth farming out.
+static const int PARALLEL_MIN_STATES = 2048;
+
+/// Fewest states formatted by one task.
+static const int PARALLEL_MIN_CHUNK = 256;
+
+/**
+ * One of the sections that has an entry per state. Entries only depend on
+ * their own state, so any range of them can be formatted on its own.
+ */
+class VerilogGenerator::StateSection
+{
+public:
+    typedef enum _Kind
+    {
+        Kind_AsciiCurrent = 0,
+        Kind_AsciiNext,
+        Kind_Arms,
+        Kind_RegisteredArms
+    }Kind;
+
+    StateSection(const VerilogGenerator *generator, Kind kind,
+        const StateEncoder& encoder, const RegisteredControls *registers,
+        const QList<State>& states, int labelLen = 0, int maxStateLen = 0) :
+        mGenerator(generator), mKind(kind), mEncoder(&encoder),
+        mRegisters(registers), mStates(&states), mLabelLen(labelLen),
+        mMaxStateLen(maxStateLen)
+    {
+        // Nothing to see here.
+    }
+
+    int count() const
+    {
+        return mStates->count();
+    }
+
+    /// Write the entries of the states in [begin, end).
+    void write(VerilogWriter& out, int begin, int end) const;
+
+    /// The same entries as UTF-8 in a buffer of their own.
+    QByteArray format(int begin, int end) const;
+
+private:
+    const VerilogGenerator *mGenerator;
+    Kind mKind;
+    const StateEncoder *mEncoder;
+    const RegisteredControls *mRegisters;
+    const QList<State> *mStates;
+    int mLabelLen;
+    int mMaxStateLen;
+};
+
+void VerilogGenerator::StateSection::write(VerilogWriter& out, int begin,
+    int end) const
+{
+    for(int i = begin; i < end; i++)
+    {
+        QString state = mStates->at(i).name();
+
+        switch(mKind)
+        {
+        case Kind_AsciiCurrent:
+            out.line(QString("%1 ascii_current_state = \"%2\";").arg(
+                padLine(mGenerator->stateLabel(*mEncoder, "current_state", i,
+                state) + ":", mLabelLen + 1)).arg(padLine(state,
+                mMaxStateLen)), 3);
+            break;
+        case Kind_AsciiNext:
+            out.line(QString("%1 ascii_next_state = \"%2\";").arg(
+                padLine(mGenerator->stateLabel(*mEncoder, "next_state", i,
+                state) + ":", mLabelLen + 1)).arg(padLine(state,
+                mMaxStateLen)), 3);
+            break;
+        case Kind_Arms:
+            out.line(QString("%1: begin").arg(mGenerator->stateLabel(
+                *mEncoder, "current_state", i, state)), 3);
+
+            out.lines(trimBlankLines(mRegisters ? mRegisters->stateCode(i) :
+                mStates->at(i).code()), 4);
+            out.line(QString("end // %1").arg(state), 3);
+            break;
+        case Kind_RegisteredArms:
+            if(!mRegisters || !mRegisters->assignsState(i))
+                break;
+
+            out.line(QString("%1: begin").arg(mGenerator->stateLabel(
+                *mEncoder, "next_state", i, state)), 3);
+
+            foreach(const QString& sigName, mRegisters->registered())
+            {
+                out.line(QString("%1 = %2;").arg(mRegisters->nextName(
+                    sigName)).arg(mRegisters->value(sigName, i)), 4);
+            }
+
+            out.line(QString("end // %1").arg(state), 3);
+            break;
+        }
+    }
+}
+
+QByteArray VerilogGenerator::StateSection::format(int begin, int end) const
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+
+    VerilogWriter out(&buffer, mGenerator->mIndentUnit);
+    write(out, begin, end);
+    out.finish();
+
+    return data;
+}
+
+static QThreadPool* sectionPool()
+{
+    // Kept apart from the global pool so a generator that is itself running
+    // there (as in the batch tool) can wait for its chunks without taking
+    // the threads they need.
+    static QThreadPool pool;
+
+    return &pool;
+}
+
+VerilogGenerator::VerilogGenerator(const Project& project) :
+    mModule(project), mParallel(true), mCancel(0)
+{
+    PassManager passes;
+    passes.addStandardPasses();
+    passes.run(mModule);
+
+    mTimings = passes.timings();
+
+    init();
+}
+
+VerilogGenerator::VerilogGenerator(const FsmModule& module) :
+    mModule(module), mParallel(true), mCancel(0)
+{
+    init();
+}
+
+void VerilogGenerator::init()
+{
+    // A module that skipped the standard passes still needs their results.
+    if(mModule.encoding() == Project::Encoding_Auto)
+        EncodingPass().run(mModule);
+
+    // Without registered signals the outputs stay null, and running the
+    // pass again only checks for them.
+    if(!mModule.outputs())
+        OutputPass().run(mModule);
+
+    const Project& project = mModule.project();
+
+    mSystemVerilog = project.language() == Project::Language_SystemVerilog;
+
+    QChar c = project.indentType() == Project::IndentType_Tabs ? '\t' : ' ';
+    mIndentUnit = QString(project.indentSize(), c);
+}
+
+QList<PassManager::Timing> VerilogGenerator::timings() const
+{
+    return mTimings;
+}
+
+int VerilogGenerator::version()
+{
+    return 2;
+}
+
+QString VerilogGenerator::generate() const
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+
+    generate(&buffer);
+
+    return QString::fromUtf8(data);
+}
+
+bool VerilogGenerator::generate(QIODevice *device) const
+{
+    const Project& project = mModule.project();
+
+    QList<IOSignal> ioSignals = project.ioSignals();
+    QList<ControlSignal> controlSignals = project.controlSignals();
+    QList<State> states = project.states();
+
+    VerilogWriter out(device, mIndentUnit);
+
+    QString header = trimBlankLines(project.headerCode());
+    if(!header.isEmpty())
+        out.line(header);
+
+    // The notes are whole comment lines already.
+    foreach(const QString& note, mModule.notes())
+        out.write(note);
+
+    out.line("`timescale 1ns / 1ps");
+
+    if(project.defaultNettype())
+        out.line("`default_nettype none");
+
+    out.blank();
+    out.line(QString("module %1(").arg(project.name()));
+
+    for(int i = 0; i < ioSignals.count(); i++)
+    {
+        out.write(out.indent());
+        out.write(ioSignals.at(i).declaration());
+        out.write(i < ioSignals.count() - 1 ? ",\n" : "\n");
+    }
+
+    if(ioSignals.isEmpty())
+        out.blank();
+
+    out.line(");", 1);
+
+    StateEncoder encoder = mModule.encoder();
+    int stateBits = encoder.bits();
+
+    out.blank();
+    out.line("// States", 1);
+
+    if(mSystemVerilog)
+    {
+        // Simulators show an enum by name, so there is no ascii decoder.
+        out.line(QString("typedef enum logic [%1:0] {").arg(stateBits - 1), 1);
+
+        for(int i = 0; i < states.count(); i++)
+        {
+            out.line(QString("%1 = %2%3").arg(states.at(i).name()).arg(
+                encoder.literal(i)).arg(i < states.count() - 1 ? "," : ""), 2);
+        }
+
+        out.line("} state_t;", 1);
+    }
+    else
+    {
+        for(int i = 0; i < states.count(); i++)
+            out.line(states.at(i).declaration(encoder, i), 1);
+    }
+
+    // Merged states stay declared for any code that still names them.
+    QList<StateReducer::Merge> merged = mModule.merged();
+
+    foreach(const StateReducer::Merge& merge, merged)
+    {
+        out.line(QString("localparam %1%2 = %3;").arg(
+            mSystemVerilog ? "state_t " : "").arg(merge.state).arg(
+            merge.into), 1);
+    }
+
+    if(!mSystemVerilog && states.isEmpty() && merged.isEmpty())
+        out.blank();
+
+    out.blank();
+    out.line("// Control Signals", 1);
+
+    // Null when no control signal is registered.
+    const RegisteredControls *registers = mModule.outputs().data();
+
+    if(registers)
+    {
+        foreach(const QString& sigName, registers->combinational())
+        {
+            out.line(QString("// %1 is not a pure function of the "
+                "state and stays combinational").arg(sigName), 1);
+        }
+    }
+
+    foreach(const ControlSignal& sig, controlSignals)
+    {
+        if(mSystemVerilog)
+            out.line(QString("logic %1;").arg(sig.name()), 1);
+        else
+            out.line(sig.declaration(), 1);
+
+        if(registers && registers->isRegistered(sig.name()))
+        {
+            out.line(QString("%1 %2;").arg(variableType()).arg(
+                registers->nextName(sig.name())), 1);
+        }
+    }
+
+    if(controlSignals.isEmpty())
+        out.blank();
+
+    out.blank();
+    if(mSystemVerilog)
+    {
+        out.line("state_t current_state;", 1);
+        out.line("state_t next_state;", 1);
+    }
+    else
+    {
+        out.line(QString("reg [%1:0] current_state;").arg(stateBits - 1), 1);
+        out.line(QString("reg [%1:0] next_state;").arg(stateBits - 1), 1);
+    }
+
+    out.blank();
+    out.line(clockedAlways(), 1);
+    out.line("begin", 1);
+    out.line(QString("if(%1) begin").arg(project.resetSignal()), 2);
+    out.line(QString("current_state <= %1;").arg(project.resetState()), 3);
+    out.line("end else begin", 2);
+    out.line("current_state <= next_state;", 3);
+    out.line("end", 2);
+    out.line("end", 1);
+    out.blank();
+
+    if(project.asciiStates() && !mSystemVerilog)
+    {
+        int maxStateLen = 0;
+        int labelLen = 0;
+
+        for(int i = 0; i < states.count(); i++)
+        {
+            QString state = states.at(i).name();
+
+            int stateLen = state.length();
+            if(stateLen > maxStateLen)
+                maxStateLen = stateLen;
+
+            // Pad to the current_state labels, the longer of the two.
+            int stateLabelLen = stateLabel(encoder, "current_state", i, state).length();
+            if(stateLabelLen > labelLen)
+                labelLen = stateLabelLen;
+        }
+
+        out.line("// synopsys translate_off", 1);
+        out.line(QString("reg [%1:0] ascii_current_state;").arg(maxStateLen * 8 - 1), 1);
+        out.line(QString("reg [%1:0] ascii_next_state;").arg(maxStateLen * 8 - 1), 1);
+        out.blank();
+        out.line("always @(current_state)", 1);
+        out.line("begin", 1);
+        out.line(stateCase(encoder, "current_state"), 2);
+
+        writeStates(out, StateSection(this, StateSection::Kind_AsciiCurrent,
+            encoder, registers, states, labelLen, maxStateLen));
+
+        out.line("endcase", 2);
+        out.line("end", 1);
+        out.line("always @(next_state)", 1);
+        out.line("begin", 1);
+        out.line(stateCase(encoder, "next_state"), 2);
+
+        writeStates(out, StateSection(this, StateSection::Kind_AsciiNext,
+            encoder, registers, states, labelLen, maxStateLen));
+
+        out.line("endcase", 2);
+        out.line("end", 1);
+
+        out.line("// synopsys translate_on", 1);
+    }
+
+    QString datapath = trimBlankLines(project.datapathCode());
+
+    if(!datapath.isEmpty())
+    {
+        out.blank();
+        out.lines(datapath);
+    }
+
+    QString tasks = trimBlankLines(project.taskCode());
+
+    if(!tasks.isEmpty())
+    {
+        out.blank();
+        out.lines(tasks);
+    }
+
+    out.blank();
+    out.line(combinationalAlways(), 1);
+    out.line("begin", 1);
+    out.line("// Default values", 2);
+    out.line("next_state = current_state;", 2);
+
+    QString stateDefaults = trimBlankLines(registers ?
+        registers->stateDefaultsCode() : project.stateDefaultsCode());
+
+    if(!stateDefaults.isEmpty())
+        out.lines(stateDefaults, 2);
+
+    foreach(const ControlSignal& sig, controlSignals)
+    {
+        if(!registers || !registers->isRegistered(sig.name()))
+            out.line(QString("%1 = 0;").arg(sig.name()), 2);
+    }
+
+    out.blank();
+    out.line(stateCase(encoder, "current_state"), 2);
+
+    writeStates(out, StateSection(this, StateSection::Kind_Arms, encoder,
+        registers, states));
+
+    out.line("endcase", 2);
+    out.line("end", 1);
+
+    if(registers && !registers->registered().isEmpty())
+    {
+        // Decode the registered signals from next_state so they come
+        // straight out of a flip-flop.
+        out.blank();
+        out.line("// Registered control signals", 1);
+        out.line(combinationalAlways(), 1);
+        out.line("begin", 1);
+
+        foreach(const QString& sigName, registers->registered())
+        {
+            out.line(QString("%1 = %2;").arg(registers->nextName(
+                sigName)).arg(registers->defaultValue(sigName)), 2);
+        }
+
+        out.blank();
+        out.line(stateCase(encoder, "next_state"), 2);
+
+        writeStates(out, StateSection(this, StateSection::Kind_RegisteredArms,
+            encoder, registers, states));
+
+        // Only some states have arms here, and unique case flags any value
+        // that matches none of them.
+        if(mSystemVerilog)
+            out.line("default: ;", 3);
+
+        out.line("endcase", 2);
+        out.line("end", 1);
+        out.blank();
+        out.line(clockedAlways(), 1);
+        out.line("begin", 1);
+        out.line(QString("if(%1) begin").arg(project.resetSignal()), 2);
+
+        int resetIndex = -1;
+        for(int i = 0; i < states.count(); i++)
+        {
+            if(states.at(i).name() == project.resetState())
+                resetIndex = i;
+        }
+
+        foreach(const QString& sigName, registers->registered())
+        {
+            out.line(QString("%1 <= %2;").arg(sigName).arg(
+                registers->value(sigName, resetIndex)), 3);
+        }
+
+        out.line("end else begin", 2);
+
+        foreach(const QString& sigName, registers->registered())
+        {
+            out.line(QString("%1 <= %2;").arg(sigName).arg(
+                registers->nextName(sigName)), 3);
+        }
+
+        out.line("end", 2);
+        out.line("end", 1);
+    }
+
+    out.line("endmodule");
+
+    if(project.defaultNettype())
+    {
+        out.blank();
+        out.line("`default_nettype wire");
+    }
+
+    return out.finish() && !isCancelled();
+}
+
+void VerilogGenerator::setParallel(bool enabled)
+{
+    mParallel = enabled;
+}
+
+void VerilogGenerator::setCancelFlag(const QAtomicInt *cancel)
+{
+    mCancel = cancel;
+}
+
+bool VerilogGenerator::isCancelled() const
+{
+    return mCancel && mCancel->load();
+}
+
+void VerilogGenerator::writeStates(VerilogWriter& out,
+    const StateSection& section) const
+{
+    int count = section.count();
+
+    if(!mParallel || count < PARALLEL_MIN_STATES)
+    {
+        // Still go in chunks so a cancel does not wait for the whole section.
+        for(int begin = 0; begin < count && !isCancelled();
+            begin += PARALLEL_MIN_CHUNK)
+        {
+            section.write(out, begin, qMin(count, begin + PARALLEL_MIN_CHUNK));
+        }
+
+        return;
+    }
+
+    int chunk = qMax(PARALLEL_MIN_CHUNK,
+        count / (sectionPool()->maxThreadCount() * 4) + 1);
+
+    QList<QFuture<QByteArray> > chunks;
+
+    for(int begin = 0; begin < count; begin += chunk)
+    {
+        chunks.append(QtConcurrent::run(sectionPool(), section,
+            &StateSection::format, begin, qMin(count, begin + chunk)));
+    }
+
+    // Written in state order, so the output matches the serial path.
+    for(int i = 0; i < chunks.count() && !isCancelled(); i++)
+        out.writeUtf8(chunks[i].result());
+
+    // The chunks point into the caller's locals, so none may outlive this
+    // even when a cancel left some unwritten.
+    for(int i = 0; i < chunks.count(); i++)
+        chunks[i].waitForFinished();
+}
+
+QString VerilogGenerator::clockedAlways() const
+{
+    const Project& project = mModule.project();
+    QString always = mSystemVerilog ? "always_ff" : "always";
+
+    if(project.resetType() == Project::ResetType_Async)
+    {
+        return QString("%1 @ (posedge %2, posedge %3)").arg(always).arg(
+            project.clockSignal()).arg(project.resetSignal());
+    }
+
+    return QString("%1 @ (posedge %2)").arg(always).arg(project.clockSignal());
+}
+
+QString VerilogGenerator::combinationalAlways() const
+{
+    return mSystemVerilog ? "always_comb" : "always @ (*)";
+}
+
+QString VerilogGenerator::variableType() const
+{
+    return mSystemVerilog ? "logic" : "reg";
+}
+
+QString VerilogGenerator::stateCase(const StateEncoder& encoder,
+    const QString& var) const
+{
+    // unique tells synthesis the arms never overlap, which the pragma only
+    // does for tools that read it.
+    if(mSystemVerilog)
+    {
+        if(encoder.encoding() == Project::Encoding_OneHot)
+            return "unique case(1'b1)";
+
+        return QString("unique case(%1)").arg(var);
+    }
+
+    // One-hot states are matched on their bit rather than the whole vector.
+    if(encoder.encoding() == Project::Encoding_OneHot)
+        return "case(1'b1) // synopsys parallel_case";
+
+    return QString("case(%1)").arg(var);
+}
+
+QString VerilogGenerator::stateLabel(const StateEncoder& encoder,
+    const QString& var, int index, const QString& state) const
+{
+    if(encoder.encoding() == Project::Encoding_OneHot)
+        return QString("%1[%2]").arg(var).arg(index);
+
+    return state;
+}
+
+QString VerilogGenerator::indent(int level) const
+{
+    return mIndentUnit.repeated(qMax(0, level));
+}
+
+QString VerilogGenerator::indentLine(const QString& line, int level) const
+{
+    return QString("%1%2").arg(indent(level)).arg(line);
+}
+
+QString VerilogGenerator::indentLines(const QString& src, int level) const
+{
+    QStringList lines = src.split("\n");
+    if(lines.isEmpty())
+        return QString();
+
+    QStringList newLines;
+
+    foreach(QString line, lines)
+        newLines.append(indentLine(line, level));
+
+    return newLines.join("\n");
+}
+
+QString VerilogGenerator::padLine(const QString& line, int length)
+{
+    QString str = line;
+
+    length -= str.length();
+
+    while(length-- > 0)
+        str += " ";
+
+    return str;
+}
+
+QString VerilogGenerator::trimBlankLines(const QString& line)
+{
+    if(line.isEmpty())
+        return QString();
+
+    QString str = line;
+    while(!str.isEmpty() && str.at(str.length() - 1).isSpace())
+        str.truncate(str.length() - 1);
+
+    return str;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VERILOGGENERATOR_H
+#define VERILOGGENERATOR_H
+
+#include <QtCore/QAtomicInt>
+
+#include "FsmModule.h"
+#include "PassManager.h"
+#include "Project.h"
+
+class StateEncoder;
+class VerilogWriter;
+
+/// Lowers an FsmModule to a Verilog or SystemVerilog module.
+class VerilogGenerator
+{
+public:
+    /// Build the module from the project with the standard passes.
+    explicit VerilogGenerator(const Project& project);
+
+    /// Lower a module as is, running only the analysis it is missing.
+    explicit VerilogGenerator(const FsmModule& module);
+
+    QString generate() const;
+
+    /// Stream the module to the device as UTF-8. False if a write failed.
+    bool generate(QIODevice *device) const;
+
+    /**
+     * Format the per-state sections of large machines on several threads.
+     * The output is the same either way. On by default.
+     */
+    void setParallel(bool enabled);
+
+    /**
+     * Give up on generate() once the flag is set from another thread. The
+     * flag has to outlive the call.
+     */
+    void setCancelFlag(const QAtomicInt *cancel);
+
+    /// Time each pass took when built from a project.
+    QList<PassManager::Timing> timings() const;
+
+    /// Bump this whenever a change alters the generated text.
+    static int version();
+
+    QString indent(int level = 1) const;
+    QString indentLine(const QString& line, int level = 1) const;
+    QString indentLines(const QString& src, int level = 1) const;
+
+    static QString padLine(const QString& line, int length = 1);
+    static QString trimBlankLines(const QString& line);
+
+private:
+    class StateSection;
+
+    QString clockedAlways() const;
+    QString combinationalAlways() const;
+    QString variableType() const;
+    QString stateCase(const StateEncoder& encoder, const QString& var) const;
+    QString stateLabel(const StateEncoder& encoder, const QString& var,
+        int index, const QString& state) const;
+
+    void init();
+    bool isCancelled() const;
+    void writeStates(VerilogWriter& out, const StateSection& section) const;
+
+    FsmModule mModule;
+    QList<PassManager::Timing> mTimings;
+    bool mParallel;
+
+    /// Use enum states, always_ff/always_comb and unique case.
+    bool mSystemVerilog;
+    const QAtomicInt *mCancel;
+
+    /// One level of indent, built once from the project options.
+    QString mIndentUnit;
+};
+
+#endif // VERILOGGENERATOR_H
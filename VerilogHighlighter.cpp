@@ -18,379 +18,581 @@
  */
 
 #include "VerilogHighlighter.h"
+#include "VerilogKeywords.h"
+#include "SymbolTable.h"
 
-VerilogHighlighter::VerilogHighlighter(QTextDocument *parent) :
-    QSyntaxHighlighter(parent), mIdentPattern("\\.([a-zA-Z_][a-zA-Z0-9_$]*|\\\\[^ \t\f\r]+)"),
-    mNumberPattern("\\b([0-9]+\\'[bhd]){0,1}[_zZxX0-9]+\\b"), mSingleCommentPattern("\\/\\/.*"),
-    mStartCommentPattern("/\\*"), mEndCommentPattern("\\*/")
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QTimer>
+
+#include <QPlainTextEdit>
+#include <QTextBlockUserData>
+
+/**
+ * The tokens of a block along with the revision and starting state they
+ * were made for, and the identifiers used in it so a change to the symbol
+ * table only rehighlights the blocks that use a changed name.
+ */
+class BlockData : public QTextBlockUserData
+{
+public:
+    BlockData() : revision(-1), startState(0), endState(0)
+    {
+        // Nothing to see here.
+    }
+
+    int revision;
+    int startState;
+    int endState;
+
+    QVector<VerilogHighlighter::Token> tokens;
+    QSet<QString> identifiers;
+};
+
+/// Milliseconds spent in each pass of highlightPending().
+static const int PENDING_MSECS = 8;
+
+static QList<VerilogHighlighter::BlockTokens> tokenizeBlocks(
+    const QStringList& texts)
+{
+    QList<VerilogHighlighter::BlockTokens> blocks;
+    int state = 0;
+
+    foreach(const QString& text, texts)
+    {
+        VerilogHighlighter::BlockTokens block;
+        block.endState = state = VerilogHighlighter::tokenize(text, state,
+            block.tokens);
+
+        blocks.append(block);
+    }
+
+    return blocks;
+}
+
+VerilogHighlighter::VerilogHighlighter(QTextDocument *parent,
+    SymbolTable *symbols) : QSyntaxHighlighter(parent), mSymbols(symbols),
+    mEditor(0)
+{
+    init();
+}
+
+VerilogHighlighter::VerilogHighlighter(QPlainTextEdit *editor,
+    SymbolTable *symbols) : QSyntaxHighlighter(editor->document()),
+    mSymbols(symbols), mEditor(editor)
 {
+    init();
+}
+
+void VerilogHighlighter::init()
+{
+    mSyncBudget = 15;
+    mBackgroundPending = false;
+    mBackgroundRestart = false;
+
     //mKeywordFormat.setFontWeight(QFont::Bold);
     mKeywordFormat.setForeground(QColor("#F92672"));
     mIdentFormat.setForeground(QColor("#66D9EF"));
     mSignalFormat.setForeground(QColor("#66D9EF"));
+    mStateFormat.setForeground(QColor("#A6E22E"));
     mNumberFormat.setForeground(QColor("#AE81FF"));
     mCommentFormat.setForeground(QColor("#75715E"));
 
-    QStringList keywords(QStringList()
-        << QString("accept_on")
-        << QString("alias")
-        << QString("always")
-        << QString("always_comb")
-        << QString("always_ff")
-        << QString("always_latch")
-        << QString("and")
-        << QString("assert")
-        << QString("assign")
-        << QString("assume")
-        << QString("automatic")
-        << QString("before")
-        << QString("begin")
-        << QString("bind")
-        << QString("bins")
-        << QString("binsof")
-        << QString("bit")
-        << QString("break")
-        << QString("buf")
-        << QString("bufif0")
-        << QString("bufif1")
-        << QString("byte")
-        << QString("case")
-        << QString("casex")
-        << QString("casez")
-        << QString("cell")
-        << QString("chandle")
-        << QString("checker")
-        << QString("class")
-        << QString("clocking")
-        << QString("cmos")
-        << QString("config")
-        << QString("const")
-        << QString("constraint")
-        << QString("context")
-        << QString("continue")
-        << QString("cover")
-        << QString("covergroup")
-        << QString("coverpoint")
-        << QString("cross")
-        << QString("deassign")
-        << QString("default")
-        << QString("defparam")
-        << QString("design")
-        << QString("disable")
-        << QString("dist")
-        << QString("do")
-        << QString("edge")
-        << QString("else")
-        << QString("end")
-        << QString("endcase")
-        << QString("endchecker")
-        << QString("endclass")
-        << QString("endclocking")
-        << QString("endconfig")
-        << QString("endfunction")
-        << QString("endgenerate")
-        << QString("endgroup")
-        << QString("endinterface")
-        << QString("endmodule")
-        << QString("endpackage")
-        << QString("endprimitive")
-        << QString("endprogram")
-        << QString("endproperty")
-        << QString("endspecify")
-        << QString("endsequence")
-        << QString("endtable")
-        << QString("endtask")
-        << QString("enum")
-        << QString("event")
-        << QString("eventually")
-        << QString("expect")
-        << QString("export")
-        << QString("extends")
-        << QString("extern")
-        << QString("final")
-        << QString("first_match")
-        << QString("for")
-        << QString("force")
-        << QString("foreach")
-        << QString("forever")
-        << QString("fork")
-        << QString("forkjoin")
-        << QString("function")
-        << QString("generate")
-        << QString("genvar")
-        << QString("global")
-        << QString("highz0")
-        << QString("highz1")
-        << QString("if")
-        << QString("iff")
-        << QString("ifnone")
-        << QString("ignore_bins")
-        << QString("illegal_bins")
-        << QString("implements")
-        << QString("implies")
-        << QString("import")
-        << QString("incdir")
-        << QString("include")
-        << QString("initial")
-        << QString("inout")
-        << QString("input")
-        << QString("inside")
-        << QString("instance")
-        << QString("int")
-        << QString("integer")
-        << QString("interconnect")
-        << QString("interface")
-        << QString("intersect")
-        << QString("join")
-        << QString("join_any")
-        << QString("join_none")
-        << QString("large")
-        << QString("let")
-        << QString("liblist")
-        << QString("library")
-        << QString("local")
-        << QString("localparam")
-        << QString("longint")
-        << QString("macromodule")
-        << QString("matches")
-        << QString("medium")
-        << QString("modport")
-        << QString("module")
-        << QString("nand")
-        << QString("negedge")
-        << QString("nettype")
-        << QString("new")
-        << QString("nexttime")
-        << QString("nmos")
-        << QString("nor")
-        << QString("noshowcancelled")
-        << QString("not")
-        << QString("notif0")
-        << QString("notif1")
-        << QString("null")
-        << QString("or")
-        << QString("output")
-        << QString("package")
-        << QString("packed")
-        << QString("parameter")
-        << QString("pmos")
-        << QString("posedge")
-        << QString("primitive")
-        << QString("priority")
-        << QString("program")
-        << QString("property")
-        << QString("protected")
-        << QString("pull0")
-        << QString("pull1")
-        << QString("pulldown")
-        << QString("pullup")
-        << QString("pulsestyle_ondetect")
-        << QString("pulsestyle_onevent")
-        << QString("pure")
-        << QString("rand")
-        << QString("randc")
-        << QString("randcase")
-        << QString("randsequence")
-        << QString("rcmos")
-        << QString("real")
-        << QString("realtime")
-        << QString("ref")
-        << QString("reject_on")
-        << QString("release")
-        << QString("repeat")
-        << QString("restrict")
-        << QString("return")
-        << QString("rnmos")
-        << QString("rpmos")
-        << QString("rtran")
-        << QString("rtranif0")
-        << QString("rtranif1")
-        << QString("s_always")
-        << QString("s_eventually")
-        << QString("s_nexttime")
-        << QString("s_until")
-        << QString("s_until_with")
-        << QString("scalared")
-        << QString("sequence")
-        << QString("shortint")
-        << QString("shortreal")
-        << QString("showcancelled")
-        << QString("signed")
-        << QString("small")
-        << QString("soft")
-        << QString("solve")
-        << QString("specify")
-        << QString("specparam")
-        << QString("static")
-        << QString("string")
-        << QString("strong")
-        << QString("strong0")
-        << QString("strong1")
-        << QString("struct")
-        << QString("super")
-        << QString("supply0")
-        << QString("supply1")
-        << QString("sync_accept_on")
-        << QString("sync_reject_on")
-        << QString("table")
-        << QString("tagged")
-        << QString("task")
-        << QString("this")
-        << QString("throughout")
-        << QString("time")
-        << QString("timeprecision")
-        << QString("timeunit")
-        << QString("tran")
-        << QString("tranif0")
-        << QString("tranif1")
-        << QString("tri")
-        << QString("tri0")
-        << QString("tri1")
-        << QString("triand")
-        << QString("trior")
-        << QString("trireg")
-        << QString("type")
-        << QString("typedef")
-        << QString("union")
-        << QString("unique")
-        << QString("unique0")
-        << QString("unsigned")
-        << QString("until")
-        << QString("until_with")
-        << QString("untyped")
-        << QString("use")
-        << QString("uwire")
-        << QString("var")
-        << QString("vectored")
-        << QString("virtual")
-        << QString("void")
-        << QString("wait")
-        << QString("wait_order")
-        << QString("wand")
-        << QString("weak")
-        << QString("weak0")
-        << QString("weak1")
-        << QString("while")
-        << QString("wildcard")
-        << QString("with")
-        << QString("within")
-        << QString("wor")
-        << QString("xnor")
-        << QString("xor"));
-
-    QStringList sigs(QStringList()
-        << QString("logic")
-        << QString("reg")
-        << QString("wire"));
-
-    QStringList symbols(QStringList()
-        << QString("<")
-        << QString(">")
-        << QString(":")
-        << QString("&")
-        << QString("%")
-        << QString("|")
-        << QString("^")
-        << QString("~")
-        << QString("!")
-        << QString("#")
-        << QString("+")
-        << QString("-")
-        << QString("/")
-        << QString("*")
-        << QString("{")
-        << QString("}")
-        << QString("="));
-
-    foreach(QString keyword, keywords)
+    if(mSymbols)
     {
-        mKeywordPatterns.append(QRegExp(QString("\\b%1\\b").arg(
-            QRegExp::escape(keyword))));
+        connect(mSymbols, SIGNAL(symbolsChanged(QSet<QString>)),
+            this, SLOT(symbolsChanged(QSet<QString>)));
     }
 
-    foreach(QString symbol, symbols)
-        mKeywordPatterns.append(QRegExp(QRegExp::escape(symbol)));
+    connect(&mBackgroundWatcher, SIGNAL(finished()),
+        this, SLOT(backgroundFinished()));
+}
+
+VerilogHighlighter::~VerilogHighlighter()
+{
+    mBackgroundWatcher.waitForFinished();
+}
+
+int VerilogHighlighter::syncBudget() const
+{
+    return mSyncBudget;
+}
+
+void VerilogHighlighter::setSyncBudget(int msecs)
+{
+    mSyncBudget = msecs;
+}
+
+static bool isIdentStart(QChar c)
+{
+    return c.isLetter() || c == '_';
+}
+
+static bool isIdentChar(QChar c)
+{
+    return c.isLetterOrNumber() || c == '_' || c == '$';
+}
+
+static bool isNumberChar(QChar c)
+{
+    return c.isDigit() || c == '_' || c == 'x' || c == 'X' ||
+        c == 'z' || c == 'Z';
+}
+
+static bool isHexChar(QChar c)
+{
+    return isNumberChar(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
 
-    foreach(QString sig, sigs)
+static bool isBaseChar(QChar c)
+{
+    switch(c.unicode())
     {
-        mSignalPatterns.append(QRegExp(QString("\\b%1\\b").arg(
-            QRegExp::escape(sig))));
+    case 'b': case 'B':
+    case 'o': case 'O':
+    case 'd': case 'D':
+    case 'h': case 'H':
+        return true;
+    default:
+        return false;
     }
 }
 
-VerilogHighlighter::~VerilogHighlighter()
+static bool isSymbol(QChar c)
 {
-    mKeywordPatterns.clear();
-    mSignalPatterns.clear();
+    switch(c.unicode())
+    {
+    case '<': case '>': case ':': case '&': case '%': case '|':
+    case '^': case '~': case '!': case '#': case '+': case '-':
+    case '/': case '*': case '{': case '}': case '=':
+        return true;
+    default:
+        return false;
+    }
 }
 
-void VerilogHighlighter::highlightBlock(const QString& text)
+int VerilogHighlighter::tokenize(const QString& text, int state,
+    QVector<Token>& tokens)
 {
-    foreach(QRegExp pattern, mKeywordPatterns)
+    const QChar *data = text.constData();
+    int len = text.length();
+    int i = 0;
+
+    int endState = 0;
+
+    Token token;
+
+    // Finish a block comment left open by the previous line.
+    if(state == 1)
     {
-        int index = text.indexOf(pattern);
-        while (index >= 0) {
-            int length = pattern.matchedLength();
-            setFormat(index, length, mKeywordFormat);
-            index = text.indexOf(pattern, index + length);
+        i = text.indexOf(QLatin1String("*/"));
+        if(i < 0)
+        {
+            i = len;
+            endState = 1;
         }
+        else
+        {
+            i += 2;
+        }
+
+        token.start = 0;
+        token.length = i;
+        token.type = TokenType_Comment;
+        tokens.append(token);
     }
 
-    foreach(QRegExp pattern, mSignalPatterns)
+    // Classify every token in one walk over the line.
+    while(i < len)
     {
-        int index = text.indexOf(pattern);
-        while (index >= 0) {
-            int length = pattern.matchedLength();
-            setFormat(index, length, mSignalFormat);
-            index = text.indexOf(pattern, index + length);
+        QChar c = data[i];
+        QChar next = i + 1 < len ? data[i + 1] : QChar();
+
+        token.start = i;
+        token.length = 0;
+
+        if(c == '/' && next == '/')
+        {
+            token.length = len - i;
+            token.type = TokenType_Comment;
+            tokens.append(token);
+            break;
+        }
+
+        if(c == '/' && next == '*')
+        {
+            i = text.indexOf(QLatin1String("*/"), i + 2);
+            if(i < 0)
+            {
+                i = len;
+                endState = 1;
+            }
+            else
+            {
+                i += 2;
+            }
+
+            token.length = i - token.start;
+            token.type = TokenType_Comment;
+            tokens.append(token);
+            continue;
         }
+
+        if(c == '"')
+        {
+            for(i++; i < len && data[i] != '"'; i++)
+            {
+                if(data[i] == '\\')
+                    i++;
+            }
+
+            i = qMin(len, i + 1);
+            continue;
+        }
+
+        // Port connections and escaped identifiers after a dot.
+        if(c == '.' && (isIdentStart(next) || next == '\\'))
+        {
+            i++;
+
+            if(next == '\\')
+            {
+                while(i < len && data[i] != ' ' && data[i] != '\t' &&
+                    data[i] != '\f' && data[i] != '\r')
+                {
+                    i++;
+                }
+            }
+            else
+            {
+                while(i < len && isIdentChar(data[i]))
+                    i++;
+            }
+
+            token.length = i - token.start;
+            token.type = TokenType_Port;
+            tokens.append(token);
+            continue;
+        }
+
+        if(isIdentChar(c) && c != '$')
+        {
+            bool number = true;
+
+            for(; i < len && isIdentChar(data[i]); i++)
+                number = number && isNumberChar(data[i]);
+
+            // A sized number, e.g. 8'hFF or 4'sb1010.
+            if(number && i + 1 < len && data[i] == '\'')
+            {
+                int base = i + 1;
+                if(base < len && (data[base] == 's' || data[base] == 'S'))
+                    base++;
+
+                if(base < len && isBaseChar(data[base]))
+                {
+                    i = base + 1;
+                    while(i < len && isHexChar(data[i]))
+                        i++;
+
+                    token.length = i - token.start;
+                    token.type = TokenType_Number;
+                    tokens.append(token);
+                    continue;
+                }
+            }
+
+            token.length = i - token.start;
+
+            QString word = QString::fromRawData(data + token.start,
+                token.length);
+
+            if(VerilogKeywords::isSignalType(word))
+                token.type = TokenType_SignalType;
+            else if(VerilogKeywords::isKeyword(word))
+                token.type = TokenType_Keyword;
+            else if(number)
+                token.type = TokenType_Number;
+            else
+                token.type = TokenType_Word;
+
+            tokens.append(token);
+            continue;
+        }
+
+        if(isSymbol(c))
+        {
+            token.length = 1;
+            token.type = TokenType_Keyword;
+            tokens.append(token);
+        }
+
+        i++;
     }
 
+    return endState;
+}
+
+void VerilogHighlighter::highlightBlock(const QString& text)
+{
+    QTextBlock block = currentBlock();
+    int startState = qMax(0, previousBlockState());
+
+    BlockData *data = static_cast<BlockData*>(currentBlockUserData());
+
+    if(!data || data->revision != block.revision() ||
+        data->startState != startState)
     {
-        int index = text.indexOf(mIdentPattern);
-        while (index >= 0) {
-            int length = mIdentPattern.matchedLength();
-            setFormat(index, length, mIdentFormat);
-            index = text.indexOf(mIdentPattern, index + length);
+        // Leave the rest of a large change to the worker thread. The block
+        // state is left alone so the following blocks are not redone.
+        if(!withinBudget())
+        {
+            scheduleBackground();
+            return;
         }
+
+        if(!data)
+        {
+            data = new BlockData;
+            setCurrentBlockUserData(data);
+        }
+
+        data->tokens.clear();
+        data->endState = tokenize(text, startState, data->tokens);
+        data->startState = startState;
+        data->revision = block.revision();
     }
 
+    applyTokens(data, text);
+    setCurrentBlockState(data->endState);
+}
+
+void VerilogHighlighter::applyTokens(BlockData *data, const QString& text)
+{
+    data->identifiers.clear();
+
+    foreach(const Token& token, data->tokens)
     {
-        int index = text.indexOf(mNumberPattern);
-        while (index >= 0) {
-            int length = mNumberPattern.matchedLength();
-            setFormat(index, length, mNumberFormat);
-            index = text.indexOf(mNumberPattern, index + length);
+        switch(token.type)
+        {
+        case TokenType_Keyword:
+            setFormat(token.start, token.length, mKeywordFormat);
+            break;
+        case TokenType_SignalType:
+            setFormat(token.start, token.length, mSignalFormat);
+            break;
+        case TokenType_Port:
+            setFormat(token.start, token.length, mIdentFormat);
+            break;
+        case TokenType_Number:
+            setFormat(token.start, token.length, mNumberFormat);
+            break;
+        case TokenType_Comment:
+            setFormat(token.start, token.length, mCommentFormat);
+            break;
+        case TokenType_Word:
+        {
+            if(!mSymbols)
+                break;
+
+            QString word = text.mid(token.start, token.length);
+            data->identifiers.insert(word);
+
+            switch(mSymbols->kind(word))
+            {
+            case SymbolTable::Kind_Signal:
+                setFormat(token.start, token.length, mSignalFormat);
+                break;
+            case SymbolTable::Kind_State:
+                setFormat(token.start, token.length, mStateFormat);
+                break;
+            default:
+                break;
+            }
+
+            break;
+        }
         }
     }
+}
+
+bool VerilogHighlighter::withinBudget()
+{
+    if(mSyncBudget < 0)
+        return true;
+
+    if(!mBudgetTimer.isValid())
+    {
+        mBudgetTimer.start();
+        QTimer::singleShot(0, this, SLOT(resetBudget()));
+    }
+
+    return mBudgetTimer.elapsed() < mSyncBudget;
+}
+
+void VerilogHighlighter::resetBudget()
+{
+    mBudgetTimer.invalidate();
+}
+
+void VerilogHighlighter::scheduleBackground()
+{
+    if(mBackgroundPending)
+        return;
+
+    // Wait for the document to finish changing before taking a copy.
+    mBackgroundPending = true;
+    QTimer::singleShot(0, this, SLOT(startBackground()));
+}
+
+void VerilogHighlighter::startBackground()
+{
+    mBackgroundPending = false;
+
+    if(mBackgroundWatcher.isRunning())
+    {
+        mBackgroundRestart = true;
+        return;
+    }
+
+    QTextDocument *doc = document();
+    if(!doc)
+        return;
+
+    QStringList texts;
+    mBackgroundRevisions.clear();
+
+    for(QTextBlock block = doc->begin(); block.isValid(); block = block.next())
+    {
+        texts.append(block.text());
+        mBackgroundRevisions.append(block.revision());
+    }
+
+    mBackgroundWatcher.setFuture(QtConcurrent::run(tokenizeBlocks, texts));
+}
+
+void VerilogHighlighter::backgroundFinished()
+{
+    QList<BlockTokens> results = mBackgroundWatcher.result();
+
+    // A restart takes new revisions, so keep the ones the results match.
+    QList<int> revisions = mBackgroundRevisions;
+
+    QTextDocument *doc = document();
+
+    if(mBackgroundRestart || !doc || doc->blockCount() != results.count())
+    {
+        mBackgroundRestart = false;
+        startBackground();
+
+        if(!doc || doc->blockCount() != results.count())
+            return;
+    }
 
+    // Store the tokens of every block that has not changed since, along
+    // with the state it ends in so the next block sees the right start.
+    QList<int> changed;
+    int state = 0;
+    int i = 0;
+
+    for(QTextBlock block = doc->begin(); block.isValid();
+        block = block.next(), i++)
     {
-        int index = text.indexOf(mSingleCommentPattern);
-        while (index >= 0) {
-            int length = mSingleCommentPattern.matchedLength();
-            setFormat(index, length, mCommentFormat);
-            index = text.indexOf(mSingleCommentPattern, index + length);
+        const BlockTokens& result = results.at(i);
+
+        if(block.revision() == revisions.at(i))
+        {
+            BlockData *data = static_cast<BlockData*>(block.userData());
+            if(!data)
+            {
+                data = new BlockData;
+                block.setUserData(data);
+            }
+
+            data->tokens = result.tokens;
+            data->startState = state;
+            data->endState = result.endState;
+            data->revision = block.revision();
+
+            block.setUserState(result.endState);
+            changed.append(i);
         }
+
+        state = result.endState;
+    }
+
+    // Do the lines on screen first.
+    int first = 0;
+    int last = -1;
+
+    if(mEditor)
+    {
+        QWidget *viewport = mEditor->viewport();
+
+        first = mEditor->cursorForPosition(QPoint(0, 0)).blockNumber();
+        last = mEditor->cursorForPosition(QPoint(0,
+            viewport->height())).blockNumber();
+    }
+
+    QList<int> visible;
+    QList<int> hidden;
+
+    foreach(int number, changed)
+    {
+        if(number >= first && number <= last)
+            visible.append(number);
+        else
+            hidden.append(number);
     }
 
-    setCurrentBlockState(0);
-
-    int startIndex = 0;
-    if(previousBlockState() != 1)
-        startIndex = text.indexOf(mStartCommentPattern);
-
-    while(startIndex >= 0) {
-        int endIndex = text.indexOf(mEndCommentPattern, startIndex);
-        int commentLength;
-        if (endIndex == -1) {
-            setCurrentBlockState(1);
-            commentLength = text.length() - startIndex;
-        } else {
-            commentLength = endIndex - startIndex
-                + mEndCommentPattern.matchedLength();
+    mPendingBlocks = visible + hidden;
+
+    highlightPending();
+}
+
+void VerilogHighlighter::highlightPending()
+{
+    QTextDocument *doc = document();
+    if(!doc)
+    {
+        mPendingBlocks.clear();
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    while(!mPendingBlocks.isEmpty() && timer.elapsed() < PENDING_MSECS)
+    {
+        QTextBlock block = doc->findBlockByNumber(mPendingBlocks.takeFirst());
+
+        if(block.isValid())
+            rehighlightBlock(block);
+    }
+
+    if(!mPendingBlocks.isEmpty())
+        QTimer::singleShot(0, this, SLOT(highlightPending()));
+}
+
+void VerilogHighlighter::symbolsChanged(const QSet<QString>& names)
+{
+    QTextDocument *doc = document();
+    if(!doc)
+        return;
+
+    for(QTextBlock block = doc->begin(); block.isValid(); block = block.next())
+    {
+        BlockData *data = static_cast<BlockData*>(block.userData());
+
+        if(!data)
+            continue;
+
+        foreach(const QString& name, names)
+        {
+            if(data->identifiers.contains(name))
+            {
+                rehighlightBlock(block);
+                break;
+            }
         }
-        setFormat(startIndex, commentLength, mCommentFormat);
-        startIndex = text.indexOf(mStartCommentPattern,
-            startIndex + commentLength);
     }
 }
@@ -20,34 +20,113 @@
 #ifndef VERILOGHIGHLIGHTER_H
 #define VERILOGHIGHLIGHTER_H
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QVector>
+
 #include <QSyntaxHighlighter>
 
+class QPlainTextEdit;
+
+class BlockData;
+class SymbolTable;
+
 class VerilogHighlighter : public QSyntaxHighlighter
 {
     Q_OBJECT
 public:
-    explicit VerilogHighlighter(QTextDocument *parent);
+    typedef enum _TokenType
+    {
+        TokenType_Keyword = 0,
+        TokenType_SignalType,
+        TokenType_Port,
+        TokenType_Number,
+        TokenType_Comment,
+        TokenType_Word
+    }TokenType;
+
+    typedef struct _Token
+    {
+        int start;
+        int length;
+        TokenType type;
+    }Token;
+
+    typedef struct _BlockTokens
+    {
+        QVector<Token> tokens;
+        int endState;
+    }BlockTokens;
+
+    /// Names in the symbol table, if one is given, are highlighted too.
+    explicit VerilogHighlighter(QTextDocument *parent,
+        SymbolTable *symbols = 0);
+
+    /// Highlight the editor's document, doing the visible lines first when
+    /// a large change is highlighted in the background.
+    explicit VerilogHighlighter(QPlainTextEdit *editor,
+        SymbolTable *symbols = 0);
+
     virtual ~VerilogHighlighter();
 
+    /**
+     * Milliseconds per event loop pass spent highlighting on the GUI
+     * thread. Once used up the rest of the change is tokenized on a worker
+     * thread. -1 always highlights on the GUI thread.
+     */
+    int syncBudget() const;
+    void setSyncBudget(int msecs);
+
+    /**
+     * Split one line into tokens. The state is 1 inside a block comment
+     * and 0 otherwise; the state at the end of the line is returned. This
+     * does not touch the highlighter so it may run on any thread.
+     */
+    static int tokenize(const QString& text, int state,
+        QVector<Token>& tokens);
+
 protected:
     virtual void highlightBlock(const QString& text);
 
+private slots:
+    /// Rehighlight only the blocks that use one of the names.
+    void symbolsChanged(const QSet<QString>& names);
+
+    void resetBudget();
+    void startBackground();
+    void backgroundFinished();
+    void highlightPending();
+
 private:
-    QRegExp mIdentPattern;
-    QTextCharFormat mIdentFormat;
+    void init();
 
-    QList<QRegExp> mSignalPatterns;
-    QTextCharFormat mSignalFormat;
+    bool withinBudget();
+    void scheduleBackground();
+
+    void applyTokens(BlockData *data, const QString& text);
+
+    SymbolTable *mSymbols;
+    QPlainTextEdit *mEditor;
+
+    int mSyncBudget;
+    QElapsedTimer mBudgetTimer;
+
+    bool mBackgroundPending;
+    bool mBackgroundRestart;
+    QList<int> mBackgroundRevisions;
+    QFutureWatcher<QList<BlockTokens> > mBackgroundWatcher;
+
+    /// Block numbers left to rehighlight from the last background pass.
+    QList<int> mPendingBlocks;
 
-    QList<QRegExp> mKeywordPatterns;
     QTextCharFormat mKeywordFormat;
+    QTextCharFormat mSignalFormat;
+    QTextCharFormat mStateFormat;
 
-    QRegExp mNumberPattern;
+    QTextCharFormat mIdentFormat;
     QTextCharFormat mNumberFormat;
-
-    QRegExp mSingleCommentPattern;
-    QRegExp mStartCommentPattern;
-    QRegExp mEndCommentPattern;
     QTextCharFormat mCommentFormat;
 };
 
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VERILOGKEYWORDS_H
+#define VERILOGKEYWORDS_H
+
+#include <QtCore/QSet>
+#include <QtCore/QString>
+
+/**
+ * The SystemVerilog reserved words, a superset of the Verilog ones. The
+ * table is built once on first use and shared by every highlighter and
+ * identifier check in the process; it is never modified afterwards so it
+ * may be read from any thread.
+ */
+class VerilogKeywords
+{
+public:
+    static const QSet<QString>& keywords();
+
+    static bool isKeyword(const QString& word);
+
+    /// Keywords that declare a signal (reg, wire and logic).
+    static bool isSignalType(const QString& word);
+};
+
+#endif // VERILOGKEYWORDS_H
@@ -18,6 +18,7 @@
  */
 
 #include "VerilogSignal.h"
+#include "VerilogKeywords.h"
 
 VerilogSignal::VerilogSignal()
 {
@@ -33,3 +34,39 @@ void VerilogSignal::setName(const QString& _name)
 {
     mName = _name;
 }
+
+bool VerilogSignal::validIdentifier(const QString& ident)
+{
+    const QChar *data = ident.constData();
+    int len = ident.length();
+
+    if(len == 0)
+        return false;
+
+    // An escaped identifier runs from the backslash to the next whitespace.
+    if(data[0] == '\\')
+    {
+        for(int i = 1; i < len; i++)
+        {
+            ushort c = data[i].unicode();
+            if(c == ' ' || c == '\t' || c == '\f' || c == '\r')
+                return false;
+        }
+
+        return len > 1;
+    }
+
+    for(int i = 0; i < len; i++)
+    {
+        ushort c = data[i].unicode();
+
+        bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+            c == '_';
+        bool digit = (c >= '0' && c <= '9') || c == '$';
+
+        if(!letter && (i == 0 || !digit))
+            return false;
+    }
+
+    return !VerilogKeywords::isKeyword(ident);
+}
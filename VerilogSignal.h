@@ -30,6 +30,8 @@ public:
     QString name() const;
     void setName(const QString& name);
 
+    static bool validIdentifier(const QString& ident);
+
 private:
     QString mName;
 };
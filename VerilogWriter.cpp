@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "VerilogWriter.h"
+
+VerilogWriter::VerilogWriter(QIODevice *device, const QString& unit) :
+    mStream(device), mUnit(unit), mFailed(false)
+{
+    mStream.setCodec("UTF-8");
+    mIndents.append(QString());
+}
+
+const QString& VerilogWriter::indent(int level)
+{
+    level = qMax(0, level);
+
+    while(mIndents.count() <= level)
+        mIndents.append(mIndents.last() + mUnit);
+
+    return mIndents.at(level);
+}
+
+void VerilogWriter::write(const QString& text)
+{
+    mStream << text;
+}
+
+void VerilogWriter::writeUtf8(const QByteArray& data)
+{
+    // Everything buffered so far has to reach the device first.
+    mStream.flush();
+
+    if(mStream.device()->write(data) != data.size())
+        mFailed = true;
+}
+
+void VerilogWriter::line(const QString& text, int level)
+{
+    mStream << indent(level) << text << '\n';
+}
+
+void VerilogWriter::lines(const QString& src, int level)
+{
+    const QString& pad = indent(level);
+    int start = 0;
+
+    // Walk the lines in place rather than splitting into a list.
+    while(true)
+    {
+        int end = src.indexOf('\n', start);
+
+        if(end < 0)
+        {
+            mStream << pad << src.midRef(start) << '\n';
+            break;
+        }
+
+        mStream << pad << src.midRef(start, end - start) << '\n';
+        start = end + 1;
+    }
+}
+
+void VerilogWriter::blank()
+{
+    mStream << '\n';
+}
+
+bool VerilogWriter::finish()
+{
+    mStream.flush();
+
+    return !mFailed && mStream.status() == QTextStream::Ok;
+}
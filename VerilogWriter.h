@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VERILOGWRITER_H
+#define VERILOGWRITER_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QIODevice>
+#include <QtCore/QString>
+#include <QtCore/QTextStream>
+#include <QtCore/QVector>
+
+/**
+ * Writes generated source to a device as UTF-8 a line at a time. Output is
+ * buffered by the stream rather than collected in one string, and the
+ * indent for each level is built only once.
+ */
+class VerilogWriter
+{
+public:
+    /// The unit is the text for one level of indent.
+    VerilogWriter(QIODevice *device, const QString& unit);
+
+    const QString& indent(int level = 1);
+
+    /// Write the text as is.
+    void write(const QString& text);
+
+    /// Write text that is already UTF-8, such as a chunk from another writer.
+    void writeUtf8(const QByteArray& data);
+
+    /// Write a line indented to the level.
+    void line(const QString& text, int level = 0);
+
+    /// Write every line of the source indented to the level.
+    void lines(const QString& src, int level = 1);
+
+    /// Write an empty line.
+    void blank();
+
+    /// Flush to the device. Returns false if any write failed.
+    bool finish();
+
+private:
+    QTextStream mStream;
+    QString mUnit;
+    QVector<QString> mIndents;
+    bool mFailed;
+};
+
+#endif // VERILOGWRITER_H
@@ -0,0 +1,362 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GenerationCache.h"
+#include "Project.h"
+
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QDirIterator>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QTextStream>
+#include <QtCore/QThreadPool>
+
+#include <iostream>
+
+typedef struct _BatchJob
+{
+    QString project;
+
+    /// Empty to write next to the project.
+    QString output;
+
+    bool force;
+    bool timings;
+}BatchJob;
+
+typedef struct _BatchResult
+{
+    QString project;
+    QString output;
+    QString error;
+    GenerationCache::Status status;
+    QList<PassManager::Timing> timings;
+}BatchResult;
+
+/// The default output path without the extension, which needs the language.
+static QString defaultOutputBase(const QString& projectPath)
+{
+    return QString("%1/%2").arg(QFileInfo(projectPath).absolutePath()).arg(
+        QFileInfo(projectPath).baseName());
+}
+
+static QString defaultOutputPath(const QString& projectPath,
+    Project::Language language)
+{
+    return QString("%1.%2").arg(defaultOutputBase(projectPath)).arg(
+        language == Project::Language_SystemVerilog ? "sv" : "v");
+}
+
+/**
+ * Load and generate a single project. This only touches its own Project
+ * snapshot so any number of these can run at once.
+ */
+static BatchResult generateProject(const BatchJob& job)
+{
+    BatchResult result;
+    result.project = job.project;
+    result.output = job.output;
+    result.status = GenerationCache::Status_Failed;
+
+    Project project;
+    if(!project.load(job.project))
+    {
+        result.error = QCoreApplication::translate("main",
+            "Failed to load the project.");
+        return result;
+    }
+
+    if(project.language() == Project::Language_VHDL)
+    {
+        result.error = QCoreApplication::translate("main",
+            "VHDL output is not supported.");
+        return result;
+    }
+
+    // The extension depends on the language so wait for the project.
+    if(result.output.isEmpty())
+        result.output = defaultOutputPath(job.project, project.language());
+
+    result.status = GenerationCache::generate(project, result.output, job.force,
+        job.timings ? &result.timings : 0);
+    if(result.status == GenerationCache::Status_Failed)
+    {
+        result.error = QCoreApplication::translate("main",
+            "Failed to save the generated module.");
+    }
+
+    return result;
+}
+
+/**
+ * Expand a command line argument into project files. Directories are
+ * searched recursively for .fsm and .fsmb files and anything else that is
+ * not a project file is read as a manifest listing one project per line.
+ */
+static bool collectProjects(const QString& arg, QStringList& projects)
+{
+    QFileInfo info(arg);
+
+    if(info.isDir())
+    {
+        QStringList found;
+
+        QDirIterator it(arg, QStringList() << "*.fsm" << "*.fsmb", QDir::Files,
+            QDirIterator::Subdirectories);
+        while(it.hasNext())
+            found.append(QFileInfo(it.next()).absoluteFilePath());
+
+        // Keep the output order stable between runs.
+        found.sort();
+        projects.append(found);
+
+        return true;
+    }
+
+    QString suffix = info.suffix().toLower();
+
+    if(suffix == "fsm" || suffix == "fsmb")
+    {
+        projects.append(info.absoluteFilePath());
+        return true;
+    }
+
+    QFile manifest(arg);
+    if(!manifest.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    QDir base = info.absoluteDir();
+    QTextStream stream(&manifest);
+
+    while(!stream.atEnd())
+    {
+        QString line = stream.readLine().trimmed();
+        if(line.isEmpty() || line.startsWith("#"))
+            continue;
+
+        projects.append(QFileInfo(base, line).absoluteFilePath());
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    a.setOrganizationName("Logic Fault");
+    a.setOrganizationDomain("com.logicfault.hdl");
+    a.setApplicationName("State of Flux");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QCoreApplication::translate("main",
+        "Generate the HDL modules for State of Flux FSM projects."));
+    parser.addHelpOption();
+
+    QCommandLineOption outputOption(QStringList() << "o" << "output",
+        QCoreApplication::translate("main", "Write the module to <file> "
+        "instead of next to the project (single project only)."),
+        QCoreApplication::translate("main", "file"));
+    parser.addOption(outputOption);
+
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs",
+        QCoreApplication::translate("main", "Generate <count> projects at "
+        "once (defaults to the number of cores)."),
+        QCoreApplication::translate("main", "count"));
+    parser.addOption(jobsOption);
+
+    QCommandLineOption forceOption(QStringList() << "f" << "force",
+        QCoreApplication::translate("main", "Regenerate projects even if "
+        "their modules are up to date."));
+    parser.addOption(forceOption);
+
+    QCommandLineOption timingsOption(QStringList() << "t" << "timings",
+        QCoreApplication::translate("main", "Print how long each stage of "
+        "generating every project took."));
+    parser.addOption(timingsOption);
+
+    QCommandLineOption convertOption(QStringList() << "c" << "convert",
+        QCoreApplication::translate("main", "Save the project to <file> "
+        "instead of generating it. A .fsmb file is written in the binary "
+        "format and anything else as XML (single project only)."),
+        QCoreApplication::translate("main", "file"));
+    parser.addOption(convertOption);
+
+    parser.addPositionalArgument("projects", QCoreApplication::translate(
+        "main", "The .fsm or .fsmb projects, directories of projects or manifest "
+        "files listing one project per line."), "[projects...]");
+
+    parser.process(a);
+
+    QStringList args = parser.positionalArguments();
+    if(args.isEmpty())
+        parser.showHelp(1);
+
+    QStringList projects;
+
+    foreach(QString arg, args)
+    {
+        if(!collectProjects(arg, projects))
+        {
+            std::cerr << "Failed to read the manifest: " <<
+                arg.toLocal8Bit().constData() << std::endl;
+            return 1;
+        }
+    }
+
+    projects.removeDuplicates();
+
+    if(projects.isEmpty())
+    {
+        std::cerr << "No projects found." << std::endl;
+        return 1;
+    }
+
+    QString convert = parser.value(convertOption);
+    if(!convert.isEmpty())
+    {
+        if(projects.count() != 1)
+        {
+            std::cerr << "--convert can only be used with a single project." <<
+                std::endl;
+            return 1;
+        }
+
+        Project project;
+        if(!project.load(projects.first()))
+        {
+            std::cerr << "Failed to load the project." << std::endl;
+            return 1;
+        }
+
+        if(!project.save(convert))
+        {
+            std::cerr << "Failed to save the project." << std::endl;
+            return 1;
+        }
+
+        return 0;
+    }
+
+    QString output = parser.value(outputOption);
+    if(!output.isEmpty() && projects.count() != 1)
+    {
+        std::cerr << "--output can only be used with a single project." <<
+            std::endl;
+        return 1;
+    }
+
+    // Projects such as foo.fsm and foo.fsmb would write the same module at
+    // the same time. The language is only known once a project is loaded,
+    // so go by the path without the extension.
+    if(output.isEmpty())
+    {
+        QHash<QString, QString> outputs;
+
+        foreach(QString project, projects)
+        {
+            QString base = defaultOutputBase(project);
+
+            if(outputs.contains(base))
+            {
+                std::cerr << outputs.value(base).toLocal8Bit().constData() <<
+                    " and " << project.toLocal8Bit().constData() <<
+                    " would both be generated to " <<
+                    base.toLocal8Bit().constData() << ".v or .sv." <<
+                    std::endl;
+                return 1;
+            }
+
+            outputs.insert(base, project);
+        }
+    }
+
+    if(parser.isSet(jobsOption))
+    {
+        int jobs = parser.value(jobsOption).toInt();
+        if(jobs < 1)
+        {
+            std::cerr << "Invalid job count." << std::endl;
+            return 1;
+        }
+
+        QThreadPool::globalInstance()->setMaxThreadCount(jobs);
+    }
+
+    QList<BatchJob> batch;
+
+    foreach(QString project, projects)
+    {
+        BatchJob job;
+        job.project = project;
+        job.output = output;
+        job.force = parser.isSet(forceOption);
+        job.timings = parser.isSet(timingsOption);
+        batch.append(job);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QList<BatchResult> results = QtConcurrent::blockingMapped<
+        QList<BatchResult> >(batch, generateProject);
+
+    qint64 elapsed = timer.elapsed();
+
+    int failed = 0;
+    int written = 0;
+    int skipped = 0;
+
+    foreach(const BatchResult& result, results)
+    {
+        switch(result.status)
+        {
+        case GenerationCache::Status_Written:
+            written++;
+            break;
+        case GenerationCache::Status_Unchanged:
+        case GenerationCache::Status_UpToDate:
+            skipped++;
+            break;
+        default:
+            failed++;
+            std::cerr << result.project.toLocal8Bit().constData() << ": " <<
+                result.error.toLocal8Bit().constData() << std::endl;
+            break;
+        }
+
+        if(!result.timings.isEmpty())
+        {
+            std::cout << result.project.toLocal8Bit().constData() << ":\n" <<
+                PassManager::report(result.timings).toLocal8Bit().constData() <<
+                std::endl;
+        }
+    }
+
+    std::cout << "Generated " << results.count() << " projects (" <<
+        written << " written, " << skipped << " unchanged, " << failed <<
+        " failed) in " << elapsed << " ms." << std::endl;
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,563 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Project.h"
+#include "VerilogGenerator.h"
+#include "VerilogHighlighter.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStringList>
+#include <QtCore/QTemporaryDir>
+
+#include <iostream>
+
+typedef struct _BenchOptions
+{
+    int states;
+    int stateLines;
+    int repeat;
+}BenchOptions;
+
+typedef struct _Bench
+{
+    const char *name;
+    const char *description;
+    void (*run)(const Project& project, const BenchOptions& opts);
+}Bench;
+
+/// Peak resident set size in kB since the last resetPeakMemory(), or -1.
+static qint64 peakMemory()
+{
+    QFile status("/proc/self/status");
+    if(!status.open(QIODevice::ReadOnly | QIODevice::Text))
+        return -1;
+
+    foreach(const QByteArray& line, status.readAll().split('\n'))
+    {
+        if(line.startsWith("VmHWM:"))
+            return line.mid(6).simplified().split(' ').first().toLongLong();
+    }
+
+    return -1;
+}
+
+/// Start the peak over from the current resident set size.
+static void resetPeakMemory()
+{
+    // Linux 4.0 and later reset VmHWM when 5 is written here.
+    QFile clearRefs("/proc/self/clear_refs");
+    if(clearRefs.open(QIODevice::WriteOnly))
+        clearRefs.write("5");
+}
+
+static QString formatPeak(qint64 kb)
+{
+    if(kb < 0)
+        return "n/a";
+
+    return QString("%1 MB").arg(kb / 1024.0, 0, 'f', 1);
+}
+
+static QString formatRate(qint64 bytes, qint64 nsecs)
+{
+    return QString("%1 MB/s").arg(nsecs ? bytes * 1000.0 / nsecs : 0.0, 0,
+        'f', 1);
+}
+
+static void report(const char *name, const QString& text)
+{
+    std::cout << name << ": " << text.toLocal8Bit().constData() << std::endl;
+}
+
+/**
+ * A project shaped like the generated ones that prompted these benchmarks:
+ * a handful of signals and many states, each a small block of code going
+ * on to a later state.
+ */
+static Project makeProject(const BenchOptions& opts)
+{
+    Project project;
+    project.setName("bench");
+
+    QList<IOSignal> ioSignals;
+    QStringList inputs;
+    inputs << "clk" << "rst" << "start" << "stop";
+
+    foreach(const QString& name, inputs)
+    {
+        IOSignal sig;
+        sig.setName(name);
+        ioSignals.append(sig);
+    }
+
+    IOSignal data;
+    data.setName("data");
+    data.setDirection(IOSignal::Direction_Output);
+    data.setType(IOSignal::Type_Reg);
+    data.setSize(8);
+    ioSignals.append(data);
+
+    project.setIOSignals(ioSignals);
+
+    QList<ControlSignal> controlSignals;
+
+    ControlSignal busy;
+    busy.setName("busy");
+    busy.setRegistered(true);
+    controlSignals.append(busy);
+
+    ControlSignal load;
+    load.setName("load");
+    controlSignals.append(load);
+
+    project.setControlSignals(controlSignals);
+
+    QList<State> states;
+    states.reserve(opts.states);
+
+    for(int i = 0; i < opts.states; i++)
+    {
+        QStringList code;
+        code.append("busy = 1;");
+        code.append(QString("if(start && !stop) next_state = s%1;").arg(
+            (i + 1) % opts.states));
+
+        for(int j = 2; j < opts.stateLines; j++)
+        {
+            if(j % 2)
+            {
+                code.append(QString("data = 8'h%1; // step %2").arg(
+                    (i + j) & 0xFF, 2, 16, QChar('0')).arg(j));
+            }
+            else
+            {
+                code.append("load = data[0] | start;");
+            }
+        }
+
+        State state;
+        state.setName(QString("s%1").arg(i));
+        state.setCode(code.join("\n"));
+        states.append(state);
+    }
+
+    project.setStates(states);
+
+    project.setClockSignal("clk");
+    project.setResetSignal("rst");
+    project.setResetState("s0");
+    project.setStateDefaultsCode("load = 0;");
+
+    return project;
+}
+
+/// Tokenize every line of state code the way the highlighter does.
+static void benchHighlight(const Project& project, const BenchOptions& opts)
+{
+    QStringList lines;
+    qint64 bytes = 0;
+
+    foreach(const State& state, project.states())
+    {
+        foreach(const QString& line, state.code().split("\n"))
+        {
+            lines.append(line);
+            bytes += line.toUtf8().size() + 1;
+        }
+    }
+
+    qint64 best = -1;
+    int tokenCount = 0;
+
+    for(int run = 0; run < opts.repeat; run++)
+    {
+        QVector<VerilogHighlighter::Token> tokens;
+        int state = 0;
+        tokenCount = 0;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        foreach(const QString& line, lines)
+        {
+            tokens.resize(0);
+            state = VerilogHighlighter::tokenize(line, state, tokens);
+            tokenCount += tokens.count();
+        }
+
+        qint64 nsecs = timer.nsecsElapsed();
+        if(best < 0 || nsecs < best)
+            best = nsecs;
+    }
+
+    report("highlight", QString("%1 lines, %2 tokens, %3 us/line, %4").arg(
+        lines.count()).arg(tokenCount).arg(lines.isEmpty() ? 0.0 :
+        best / 1000.0 / lines.count(), 0, 'f', 3).arg(formatRate(bytes,
+        best)));
+}
+
+/// Load the project back from both formats, then check every name again.
+static void benchLoad(const Project& project, const BenchOptions& opts)
+{
+    QTemporaryDir dir;
+    if(!dir.isValid())
+    {
+        report("load", "failed to create a temporary directory");
+        return;
+    }
+
+    QStringList paths;
+    paths << dir.path() + "/bench.fsm" << dir.path() + "/bench.fsmb";
+
+    foreach(const QString& path, paths)
+    {
+        if(!project.save(path))
+        {
+            report("load", QString("failed to save %1").arg(path));
+            return;
+        }
+    }
+
+    foreach(const QString& path, paths)
+    {
+        qint64 best = -1;
+        int states = 0;
+
+        for(int run = 0; run < opts.repeat; run++)
+        {
+            Project loaded;
+
+            QElapsedTimer timer;
+            timer.start();
+
+            bool ok = loaded.load(path);
+            qint64 nsecs = timer.nsecsElapsed();
+
+            if(!ok)
+            {
+                report("load", QString("failed to load %1").arg(path));
+                return;
+            }
+
+            states = loaded.states().count();
+
+            if(best < 0 || nsecs < best)
+                best = nsecs;
+        }
+
+        report("load", QString(".%1, %2 states, %3 ms, %4").arg(
+            QFileInfo(path).suffix()).arg(states).arg(best / 1000000.0, 0,
+            'f', 1).arg(formatRate(QFileInfo(path).size(), best)));
+    }
+
+    // Loading an XML project checks every one of these names.
+    QStringList names;
+
+    foreach(const IOSignal& sig, project.ioSignals())
+        names.append(sig.name());
+
+    foreach(const ControlSignal& sig, project.controlSignals())
+        names.append(sig.name());
+
+    foreach(const State& state, project.states())
+        names.append(state.name());
+
+    qint64 best = -1;
+    int valid = 0;
+
+    for(int run = 0; run < opts.repeat; run++)
+    {
+        valid = 0;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        foreach(const QString& name, names)
+        {
+            if(VerilogSignal::validIdentifier(name))
+                valid++;
+        }
+
+        qint64 nsecs = timer.nsecsElapsed();
+        if(best < 0 || nsecs < best)
+            best = nsecs;
+    }
+
+    report("load", QString("identifier check, %1 names (%2 valid), "
+        "%3 ns/name").arg(names.count()).arg(valid).arg(
+        (double)best / names.count(), 0, 'f', 1));
+}
+
+/// Save the way it was done before streaming, with the whole document in
+/// memory as a string and again as UTF-8.
+static bool saveInMemory(const Project& project, const QString& path)
+{
+    QByteArray data = project.toXml().toUtf8();
+
+    QFile file(path);
+
+    return file.open(QIODevice::WriteOnly) &&
+        file.write(data) == data.size();
+}
+
+/**
+ * Save the project streamed to XML and binary files against building the
+ * XML in memory first. --lines sets the size, e.g. -l 80 gives about
+ * 100 MB of XML with the default state count.
+ */
+static void benchSave(const Project& project, const BenchOptions& opts)
+{
+    QTemporaryDir dir;
+    if(!dir.isValid())
+    {
+        report("save", "failed to create a temporary directory");
+        return;
+    }
+
+    QStringList labels;
+    labels << "in memory .fsm" << "streamed .fsm" << "streamed .fsmb";
+
+    QStringList paths;
+    paths << dir.path() + "/memory.fsm" << dir.path() + "/bench.fsm" <<
+        dir.path() + "/bench.fsmb";
+
+    for(int i = 0; i < paths.count(); i++)
+    {
+        qint64 best = -1;
+        qint64 peak = -1;
+
+        for(int run = 0; run < opts.repeat; run++)
+        {
+            QFile::remove(paths.at(i));
+
+            resetPeakMemory();
+            qint64 base = peakMemory();
+
+            QElapsedTimer timer;
+            timer.start();
+
+            bool ok = i == 0 ? saveInMemory(project, paths.at(i)) :
+                project.save(paths.at(i));
+            qint64 nsecs = timer.nsecsElapsed();
+
+            if(!ok)
+            {
+                report("save", QString("failed to save %1").arg(paths.at(i)));
+                return;
+            }
+
+            if(base >= 0)
+                peak = qMax(peak, peakMemory() - base);
+
+            if(best < 0 || nsecs < best)
+                best = nsecs;
+        }
+
+        qint64 size = QFileInfo(paths.at(i)).size();
+
+        report("save", QString("%1, %2 MB, %3 ms, %4, peak +%5").arg(
+            labels.at(i)).arg(size / 1048576.0, 0, 'f', 1).arg(
+            best / 1000000.0, 0, 'f', 1).arg(formatRate(size, best)).arg(
+            formatPeak(peak)));
+    }
+}
+
+typedef enum _GenerateTarget
+{
+    GenerateTarget_String = 0,
+    GenerateTarget_Buffer,
+    GenerateTarget_File
+}GenerateTarget;
+
+/// Generate the module, returning its size in bytes or -1 on failure.
+static qint64 generateModule(const Project& project, GenerateTarget target,
+    const QString& path)
+{
+    VerilogGenerator generator(project);
+
+    if(target == GenerateTarget_String)
+        return generator.generate().toUtf8().size();
+
+    if(target == GenerateTarget_Buffer)
+    {
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+
+        return generator.generate(&buffer) ? data.size() : -1;
+    }
+
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly) || !generator.generate(&file))
+        return -1;
+
+    return file.size();
+}
+
+/**
+ * Generate the module into a string, into a buffer the way the GUI and the
+ * cache do, and streamed to a file, from the passes to the last byte.
+ */
+static void benchGenerate(const Project& project, const BenchOptions& opts)
+{
+    QTemporaryDir dir;
+    if(!dir.isValid())
+    {
+        report("generate", "failed to create a temporary directory");
+        return;
+    }
+
+    QString path = dir.path() + "/bench.v";
+
+    QStringList labels;
+    labels << "to a string" << "to a buffer" << "streamed to a file";
+
+    for(int i = 0; i < labels.count(); i++)
+    {
+        qint64 best = -1;
+        qint64 peak = -1;
+        qint64 size = 0;
+
+        for(int run = 0; run < opts.repeat; run++)
+        {
+            resetPeakMemory();
+            qint64 base = peakMemory();
+
+            QElapsedTimer timer;
+            timer.start();
+
+            size = generateModule(project, (GenerateTarget)i, path);
+            qint64 nsecs = timer.nsecsElapsed();
+
+            if(size < 0)
+            {
+                report("generate", QString("failed %1").arg(labels.at(i)));
+                return;
+            }
+
+            if(base >= 0)
+                peak = qMax(peak, peakMemory() - base);
+
+            if(best < 0 || nsecs < best)
+                best = nsecs;
+        }
+
+        report("generate", QString("%1, %2 MB, %3 ms, %4, peak +%5").arg(
+            labels.at(i)).arg(size / 1048576.0, 0, 'f', 1).arg(
+            best / 1000000.0, 0, 'f', 1).arg(formatRate(size, best)).arg(
+            formatPeak(peak)));
+    }
+}
+
+static const Bench benches[] = {
+    { "highlight", "Tokenize the state code as the highlighter does.",
+        benchHighlight },
+    { "load", "Load the project as XML and binary and check its names.",
+        benchLoad },
+    { "save", "Save the project streamed and with the XML in memory.",
+        benchSave },
+    { "generate", "Generate the Verilog module into memory and to a file.",
+        benchGenerate },
+    { 0, 0, 0 }
+};
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    a.setApplicationName("State of Flux");
+
+    QString benchList;
+    for(int i = 0; benches[i].name; i++)
+    {
+        benchList += QString("\n  %1  %2").arg(QString(
+            benches[i].name).leftJustified(10)).arg(benches[i].description);
+    }
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QCoreApplication::translate("main",
+        "Time the parts of State of Flux that scale with the project on a "
+        "generated project. The benchmarks are:%1").arg(benchList));
+    parser.addHelpOption();
+
+    QCommandLineOption statesOption(QStringList() << "s" << "states",
+        QCoreApplication::translate("main", "Generate <count> states "
+        "(default 50000)."), QCoreApplication::translate("main", "count"),
+        "50000");
+    parser.addOption(statesOption);
+
+    QCommandLineOption linesOption(QStringList() << "l" << "lines",
+        QCoreApplication::translate("main", "Give every state <count> lines "
+        "of code (default 8)."), QCoreApplication::translate("main",
+        "count"), "8");
+    parser.addOption(linesOption);
+
+    QCommandLineOption repeatOption(QStringList() << "r" << "repeat",
+        QCoreApplication::translate("main", "Report the best of <count> "
+        "runs (default 3)."), QCoreApplication::translate("main", "count"),
+        "3");
+    parser.addOption(repeatOption);
+
+    parser.addPositionalArgument("benchmarks", QCoreApplication::translate(
+        "main", "The benchmarks to run, all of them if none are given."),
+        "[benchmarks...]");
+
+    parser.process(a);
+
+    BenchOptions opts;
+    opts.states = parser.value(statesOption).toInt();
+    opts.stateLines = qMax(2, parser.value(linesOption).toInt());
+    opts.repeat = parser.value(repeatOption).toInt();
+
+    if(opts.states < 1 || opts.repeat < 1)
+    {
+        std::cerr << "Invalid state or repeat count." << std::endl;
+        return 1;
+    }
+
+    QStringList names = parser.positionalArguments();
+    QList<const Bench*> run;
+
+    for(int i = 0; benches[i].name; i++)
+    {
+        if(names.isEmpty() || names.removeAll(benches[i].name))
+            run.append(&benches[i]);
+    }
+
+    if(!names.isEmpty())
+    {
+        std::cerr << "Unknown benchmark: " <<
+            names.first().toLocal8Bit().constData() << std::endl;
+        return 1;
+    }
+
+    Project project = makeProject(opts);
+
+    std::cout << "Project with " << opts.states << " states of " <<
+        opts.stateLines << " lines." << std::endl;
+
+    foreach(const Bench *bench, run)
+        bench->run(project, opts);
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+# Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+#
+# This file is part of State of Flux.
+#
+# State of Flux is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# State of Flux is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+
+# Sources shared by the GUI and the batch generator. None of these may
+# depend on QtWidgets.
+
+QT       += core concurrent
+
+SOURCES += \
+    IOSignal.cpp \
+    VerilogKeywords.cpp \
+    VerilogSignal.cpp \
+    ControlSignal.cpp \
+    State.cpp \
+    MappedFile.cpp \
+    StateEncoder.cpp \
+    EncodingSelector.cpp \
+    RegisteredControls.cpp \
+    TransitionGraph.cpp \
+    StateReducer.cpp \
+    Project.cpp \
+    ProjectBinary.cpp \
+    FsmModule.cpp \
+    FsmPass.cpp \
+    PassManager.cpp \
+    VerilogWriter.cpp \
+    VerilogGenerator.cpp \
+    GenerationCache.cpp
+
+HEADERS  += \
+    IOSignal.h \
+    VerilogKeywords.h \
+    VerilogSignal.h \
+    ControlSignal.h \
+    State.h \
+    MappedFile.h \
+    StateEncoder.h \
+    EncodingSelector.h \
+    RegisteredControls.h \
+    TransitionGraph.h \
+    StateReducer.h \
+    Project.h \
+    ProjectBinary.h \
+    FsmModule.h \
+    FsmPass.h \
+    PassManager.h \
+    VerilogWriter.h \
+    VerilogGenerator.h \
+    GenerationCache.h
@@ -15,49 +15,14 @@
 # You should have received a copy of the GNU General Public License
 # along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
 
-#-------------------------------------------------
-#
-# Project created by QtCreator 2015-03-01T12:59:33
-#
-#-------------------------------------------------
-
-QT       += core gui xml
-
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-
-TARGET = state_of_flux
-TEMPLATE = app
-
-RC_FILE += state_of_flux.rc
-
-SOURCES += main.cpp\
-        MainWindow.cpp \
-    IOSignal.cpp \
-    VerilogSignal.cpp \
-    IOSignalModel.cpp \
-    IOSignalModelInputs.cpp \
-    ControlSignal.cpp \
-    ControlSignalModel.cpp \
-    State.cpp \
-    StateModel.cpp \
-    VerilogHighlighter.cpp
-
-HEADERS  += MainWindow.h \
-    IOSignal.h \
-    VerilogSignal.h \
-    IOSignalModel.h \
-    IOSignalModelInputs.h \
-    ControlSignal.h \
-    ControlSignalModel.h \
-    State.h \
-    StateModel.h \
-    VerilogHighlighter.h
-
-FORMS    += MainWindow.ui \
-    InsertRegister.ui
+TEMPLATE = subdirs
 
-RESOURCES += \
-    state_of_flux.qrc
+# The GUI, the headless batch generator, the benchmarks and the tests share
+# the sources listed in state_of_flux.pri and are built side by side in the
+# same directory.
+SUBDIRS = gui batch bench tests
 
-OTHER_FILES += \
-    state_of_flux.rc
+gui.file = state_of_flux_gui.pro
+batch.file = state_of_flux_batch.pro
+bench.file = state_of_flux_bench.pro
+tests.file = state_of_flux_tests.pro
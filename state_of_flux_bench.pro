@@ -0,0 +1,40 @@
+# Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+#
+# This file is part of State of Flux.
+#
+# State of Flux is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# State of Flux is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+
+# Benchmarks for the code that scales with the size of a project. The
+# highlighter needs QtGui and QtWidgets, but no window is ever shown.
+
+QT       += core gui widgets concurrent
+
+TARGET = state_of_flux_bench
+TEMPLATE = app
+
+CONFIG   += console
+CONFIG   -= app_bundle
+
+# Keep the shared objects and moc output apart from the other builds.
+OBJECTS_DIR = bench
+MOC_DIR = bench
+
+include(state_of_flux.pri)
+
+SOURCES += bench_main.cpp \
+    SymbolTable.cpp \
+    VerilogHighlighter.cpp
+
+HEADERS += SymbolTable.h \
+    VerilogHighlighter.h
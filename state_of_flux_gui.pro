@@ -0,0 +1,61 @@
+# Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+#
+# This file is part of State of Flux.
+#
+# State of Flux is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# State of Flux is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+
+#-------------------------------------------------
+#
+# Project created by QtCreator 2015-03-01T12:59:33
+#
+#-------------------------------------------------
+
+QT       += core gui concurrent
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = state_of_flux
+TEMPLATE = app
+
+RC_FILE += state_of_flux.rc
+
+include(state_of_flux.pri)
+
+SOURCES += main.cpp\
+        MainWindow.cpp \
+    IOSignalModel.cpp \
+    IOSignalModelInputs.cpp \
+    ControlSignalModel.cpp \
+    StateModel.cpp \
+    ProjectCommand.cpp \
+    SymbolTable.cpp \
+    VerilogHighlighter.cpp
+
+HEADERS  += MainWindow.h \
+    IOSignalModel.h \
+    IOSignalModelInputs.h \
+    ControlSignalModel.h \
+    StateModel.h \
+    ProjectCommand.h \
+    SymbolTable.h \
+    VerilogHighlighter.h
+
+FORMS    += MainWindow.ui \
+    InsertRegister.ui
+
+RESOURCES += \
+    state_of_flux.qrc
+
+OTHER_FILES += \
+    state_of_flux.rc
@@ -0,0 +1,46 @@
+# Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+#
+# This file is part of State of Flux.
+#
+# State of Flux is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# State of Flux is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+
+# Checks for the shared sources and the highlighter. Run with make check.
+# They need QtGui for the highlighter but never show a window.
+
+QT       += core gui widgets concurrent testlib
+
+TARGET = state_of_flux_tests
+TEMPLATE = app
+
+CONFIG   += console testcase
+CONFIG   -= app_bundle
+
+# Keep the shared objects and moc output apart from the other builds.
+OBJECTS_DIR = tests
+MOC_DIR = tests
+
+include(state_of_flux.pri)
+
+SOURCES += tests_main.cpp \
+    IOSignalModel.cpp \
+    ControlSignalModel.cpp \
+    StateModel.cpp \
+    SymbolTable.cpp \
+    VerilogHighlighter.cpp
+
+HEADERS += IOSignalModel.h \
+    ControlSignalModel.h \
+    StateModel.h \
+    SymbolTable.h \
+    VerilogHighlighter.h
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2015 John Eric Martin <john.eric.martin@gmail.com>
+ *
+ * This file is part of State of Flux.
+ *
+ * State of Flux is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * State of Flux is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with State of Flux.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "IOSignalModel.h"
+#include "StateModel.h"
+#include "StateReducer.h"
+#include "SymbolTable.h"
+#include "VerilogHighlighter.h"
+
+#include <QtGui/QGuiApplication>
+#include <QtGui/QTextBlock>
+#include <QtGui/QTextDocument>
+#include <QtGui/QTextLayout>
+
+#include <QtTest/QtTest>
+
+class Tests : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void highlightIOSignal();
+    void mergeUnnamedStates();
+};
+
+/// Foreground colour the highlighter gave the character, if any.
+static QColor foregroundAt(const QTextBlock& block, int pos)
+{
+    foreach(const QTextLayout::FormatRange& range, block.layout()->formats())
+    {
+        if(pos >= range.start && pos < range.start + range.length)
+            return range.format.foreground().color();
+    }
+
+    return QColor();
+}
+
+void Tests::highlightIOSignal()
+{
+    IOSignalModel ioSignals;
+    StateModel states;
+
+    // The display text of an IO signal is its whole declaration.
+    IOSignal *sig = new IOSignal;
+    sig->setName("data_in");
+    sig->setSize(8);
+    ioSignals.append(sig);
+
+    State *state = new State;
+    state->setName("idle");
+    states.append(state);
+
+    SymbolTable symbols;
+    symbols.addModel(&ioSignals, SymbolTable::Kind_Signal);
+    symbols.addModel(&states, SymbolTable::Kind_State);
+
+    QTextDocument doc;
+    VerilogHighlighter highlighter(&doc, &symbols);
+    highlighter.setSyncBudget(-1);
+
+    doc.setPlainText("if(data_in == other) next_state = idle;");
+
+    // The table updates once control is back in the event loop.
+    QCoreApplication::processEvents();
+
+    QCOMPARE(symbols.kind("data_in"), SymbolTable::Kind_Signal);
+    QCOMPARE(symbols.kind("idle"), SymbolTable::Kind_State);
+
+    QTextBlock block = doc.firstBlock();
+    QVERIFY(foregroundAt(block, 3).isValid());
+    QVERIFY(!foregroundAt(block, 14).isValid());
+    QVERIFY(foregroundAt(block, 34).isValid());
+}
+
+/// A state with the given name and code.
+static State makeState(const QString& name, const QString& code)
+{
+    State state;
+    state.setName(name);
+    state.setCode(code);
+
+    return state;
+}
+
+void Tests::mergeUnnamedStates()
+{
+    QList<State> states;
+    states << makeState("idle", "next_state = a;")
+        << makeState("a", "busy = 1;\nnext_state = idle;")
+        << makeState("b", "busy = 1;\nnext_state = idle;")
+        << makeState("c", "busy = 1;\nnext_state = idle;")
+        << makeState("d", "busy = 1;\nnext_state = idle;");
+
+    Project project;
+    project.setStates(states);
+    project.setResetState("idle");
+    project.setMergeEquivalent(true);
+
+    // b is compared against, so merging it into a would make the
+    // comparison true in a as well. c is only named in a comment.
+    project.setDatapathCode("assign in_b = current_state == b; // c");
+
+    StateReducer reducer(project, TransitionGraph(project));
+
+    QList<StateReducer::Merge> merged = reducer.merged();
+    QCOMPARE(merged.count(), 2);
+    QCOMPARE(merged.at(0).state, QString("c"));
+    QCOMPARE(merged.at(0).into, QString("a"));
+    QCOMPARE(merged.at(1).state, QString("d"));
+    QCOMPARE(merged.at(1).into, QString("a"));
+}
+
+int main(int argc, char *argv[])
+{
+    // The highlighter needs a GUI application but there is no window.
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication a(argc, argv);
+
+    Tests tests;
+    return QTest::qExec(&tests, argc, argv);
+}
+
+#include "tests_main.moc"